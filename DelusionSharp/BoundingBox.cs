@@ -0,0 +1,14 @@
+﻿namespace DelusionSharp
+{
+    public struct BoundingBox
+    {
+        public Vector2 Min { get; set; }
+        public Vector2 Max { get; set; }
+        
+        public BoundingBox(Vector2 min, Vector2 max)
+        {
+            Min = min;
+            Max = max;
+        }
+    }
+}
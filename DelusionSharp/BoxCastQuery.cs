@@ -0,0 +1,19 @@
+﻿namespace DelusionSharp
+{
+    // Box of the given size and rotation swept from its center along the translation
+    public struct BoxCastQuery
+    {
+        public Vector2 Center { get; set; }
+        public Vector2 Size { get; set; }
+        public Vector2 Translation { get; set; }
+        public float Rotation { get; set; }
+        
+        public BoxCastQuery(Vector2 center, Vector2 size, Vector2 translation, float rotation)
+        {
+            Center = center;
+            Size = size;
+            Translation = translation;
+            Rotation = rotation;
+        }
+    }
+}
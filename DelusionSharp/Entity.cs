@@ -6,6 +6,17 @@ namespace DelusionSharp
     {
         internal UniqueId _id;
 
+        public UniqueId Id
+        {
+            get => _id;
+        }
+
+        // Entity with the given id, e.g. one found by a physics query
+        public static Entity FromId(UniqueId id)
+        {
+            return new Entity { _id = id };
+        }
+
         public bool HasComponent<T>()
         {
             var type = typeof(T);
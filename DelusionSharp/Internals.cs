@@ -101,5 +101,18 @@ namespace DelusionSharp
         
         [MethodImpl(MethodImplOptions.InternalCall)]
         internal static extern void SetBoxColliderOffset(UniqueId id, Vector2 offset);
+        
+        // Physics queries
+        
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        internal static extern void QueryOverlaps(
+            BoundingBox* queries, int queryCount, UniqueId* results, int resultCapacity, int* resultCounts, int* result
+        );
+        
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        internal static extern void Raycast(RaycastQuery* queries, int queryCount, QueryHit* hits);
+        
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        internal static extern void BoxCast(BoxCastQuery* queries, int queryCount, QueryHit* hits);
     }
 }
@@ -0,0 +1,58 @@
+﻿using System;
+
+namespace DelusionSharp
+{
+    // Queries against the colliders of the running simulation. Each call answers a whole batch of queries at once and
+    // writes into the arrays passed in, so hundreds of queries a frame cost a single call into the engine.
+    public static unsafe class Physics
+    {
+        // Collects the ids of the entities overlapping each box into the results, one query after the other, and
+        // stores how many were found for each query into the result counts. Results which don't fit are dropped.
+        // Returns the total number of results written.
+        public static int QueryOverlaps(BoundingBox[] queries, int queryCount, UniqueId[] results, int[] resultCounts)
+        {
+            if (queryCount < 0 || queryCount > queries.Length || queryCount > resultCounts.Length)
+                throw new Exception("Query count exceeds the arrays");
+            
+            int result;
+
+            fixed (BoundingBox* queriesPointer = queries)
+            fixed (UniqueId* resultsPointer = results)
+            fixed (int* resultCountsPointer = resultCounts)
+            {
+                Internals.QueryOverlaps(
+                    queriesPointer, queryCount, resultsPointer, results.Length, resultCountsPointer, &result
+                );
+            }
+
+            return result;
+        }
+
+        // Stores the closest hit along each ray into the hits
+        public static void Raycast(RaycastQuery[] queries, int queryCount, QueryHit[] hits)
+        {
+            if (queryCount < 0 || queryCount > queries.Length || queryCount > hits.Length)
+                throw new Exception("Query count exceeds the arrays");
+            
+            fixed (RaycastQuery* queriesPointer = queries)
+            fixed (QueryHit* hitsPointer = hits)
+            {
+                Internals.Raycast(queriesPointer, queryCount, hitsPointer);
+            }
+        }
+
+        // Stores the first collider each box runs into in the hits, boxes overlapping a collider from the start hit it
+        // at fraction 0, at the box's center and without a normal
+        public static void BoxCast(BoxCastQuery[] queries, int queryCount, QueryHit[] hits)
+        {
+            if (queryCount < 0 || queryCount > queries.Length || queryCount > hits.Length)
+                throw new Exception("Query count exceeds the arrays");
+            
+            fixed (BoxCastQuery* queriesPointer = queries)
+            fixed (QueryHit* hitsPointer = hits)
+            {
+                Internals.BoxCast(queriesPointer, queryCount, hitsPointer);
+            }
+        }
+    }
+}
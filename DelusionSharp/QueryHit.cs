@@ -0,0 +1,19 @@
+﻿namespace DelusionSharp
+{
+    // Closest hit of a cast, the fraction is how far along the ray or translation it is
+    public struct QueryHit
+    {
+        public UniqueId Id { get; private set; }
+        public Vector2 Point { get; private set; }
+        public Vector2 Normal { get; private set; }
+        public float Fraction { get; private set; }
+
+        public bool IsHit
+        {
+            get => _isHit != 0;
+        }
+
+        // Written by the engine, bool isn't blittable
+        private uint _isHit;
+    }
+}
@@ -0,0 +1,14 @@
+﻿namespace DelusionSharp
+{
+    public struct RaycastQuery
+    {
+        public Vector2 From { get; set; }
+        public Vector2 To { get; set; }
+        
+        public RaycastQuery(Vector2 from, Vector2 to)
+        {
+            From = from;
+            To = to;
+        }
+    }
+}
@@ -11,5 +11,10 @@
         
         public abstract void OnCreate();
         public abstract void OnUpdate(float deltaTime);
+
+        // Called at the engine's fixed rate, before every physics step
+        public virtual void OnFixedUpdate(float fixedDeltaTime)
+        {
+        }
     }
 }
@@ -8,11 +8,13 @@
 #include "editor/ui/AssetBrowserPanel.hpp"
 #include "editor/ui/HierarchyPanel.hpp"
 #include "editor/ui/PropertiesPanel.hpp"
+#include "editor/ui/StatisticsPanel.hpp"
 #include "editor/ui/ViewportPanel.hpp"
 
 #include <delusion/AssetManager.hpp>
 #include <delusion/Engine.hpp>
 #include <delusion/graphics/OrthographicCamera.hpp>
+#include <delusion/graphics/Renderer.hpp>
 #include <delusion/graphics/Texture2D.hpp>
 #include <delusion/Scene.hpp>
 #include <delusion/SceneSerde.hpp>
@@ -38,6 +40,7 @@ class Editor {
         ViewportPanel m_viewportPanel;
         AssetBrowserPanel m_assetBrowserPanel;
         PropertiesPanel m_propertiesPanel;
+        StatisticsPanel m_statisticsPanel;
 
         bool m_isPlaying = false;
     public:
@@ -47,7 +50,7 @@ class Editor {
             std::shared_ptr<Texture2D> playIconTexture, std::shared_ptr<Texture2D> stopIconTexture
         );
 
-        void onEditorUpdate(std::shared_ptr<Texture2D> &viewportTexture, float deltaTime);
+        void onEditorUpdate(std::shared_ptr<Texture2D> &viewportTexture, const Renderer &renderer, float deltaTime);
         void onRuntimeUpdate(float deltaTime);
 
         [[nodiscard]] std::shared_ptr<Scene> &scene() {
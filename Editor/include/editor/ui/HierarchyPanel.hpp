@@ -11,17 +11,21 @@ class HierarchyPanel {
     private:
         Engine *m_engine {};
 
-        Entity *m_selectedEntity {};
+        std::optional<Entity> m_selectedEntity {};
     public:
         explicit HierarchyPanel(Engine *engine) : m_engine(engine) {}
 
         void onUpdate();
 
+        // Null once the selected entity, or one of its ancestors, has been removed.
         Entity *selectedEntity() {
-            return m_selectedEntity;
+            if (!m_selectedEntity.has_value() || !m_selectedEntity->isValid())
+                return nullptr;
+
+            return &m_selectedEntity.value();
         }
 
-        void setSelectedEntity(Entity *entity) {
+        void setSelectedEntity(std::optional<Entity> entity) {
             m_selectedEntity = entity;
         }
     private:
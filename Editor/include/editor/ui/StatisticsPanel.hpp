@@ -0,0 +1,11 @@
+#pragma once
+
+#include <imgui.h>
+
+#include <delusion/graphics/GraphicsBackend.hpp>
+#include <delusion/graphics/Renderer.hpp>
+
+class StatisticsPanel {
+    public:
+        void onUpdate(const Renderer &renderer, GraphicsBackend &graphicsBackend, float deltaTime);
+};
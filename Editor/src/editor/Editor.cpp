@@ -7,6 +7,7 @@
 #include <imgui.h>
 #include <nfd.hpp>
 
+#include "delusion/AtlasBuilder.hpp"
 #include "delusion/Components.hpp"
 #include "delusion/io/FileUtilities.hpp"
 
@@ -25,7 +26,7 @@ Editor::Editor(
     m_engine->setCurrentScene(m_scene);
 }
 
-void Editor::onEditorUpdate(std::shared_ptr<Texture2D> &viewportTexture, float deltaTime) {
+void Editor::onEditorUpdate(std::shared_ptr<Texture2D> &viewportTexture, const Renderer &renderer, float deltaTime) {
     if (!m_project.has_value()) {
         onProjectPanel();
     } else {
@@ -37,6 +38,7 @@ void Editor::onEditorUpdate(std::shared_ptr<Texture2D> &viewportTexture, float d
         m_viewportPanel.onUpdate(project, viewportTexture, deltaTime);
         m_assetBrowserPanel.onUpdate(project);
         m_propertiesPanel.onUpdate();
+        m_statisticsPanel.onUpdate(renderer, *m_engine->graphicsBackend(), deltaTime);
     }
 }
 
@@ -60,7 +62,37 @@ void Editor::onRuntimeUpdate(float deltaTime) {
                 }
             });
 
-            m_engine->currentScene()->onUpdate(deltaTime);
+            auto &fixedTimestep = m_engine->fixedTimestep();
+            auto stepDuration = fixedTimestep.stepDuration();
+            auto stepCount = fixedTimestep.advance(deltaTime);
+
+            for (uint32_t step = 0; step < stepCount; step++) {
+                m_engine->currentScene()->forEachEntity([&stepDuration](Entity &entity) {
+                    if (entity.hasComponent<ScriptComponent>()) {
+                        auto &script = entity.getComponent<ScriptComponent>();
+
+                        auto scriptClass = CSharpClass(static_cast<MonoClass *>(script.class_));
+                        auto instance = CSharpObject(static_cast<MonoObject *>(script.instance));
+
+                        // Optional, only scripts overriding it have it
+                        auto onFixedUpdateMethod = scriptClass.getMethod("OnFixedUpdate", 1);
+
+                        if (onFixedUpdateMethod == nullptr)
+                            return;
+
+                        float *stepDurationPtr = &stepDuration;
+
+                        mono_runtime_invoke(
+                            onFixedUpdateMethod, instance.getMonoObject(), reinterpret_cast<void **>(&stepDurationPtr),
+                            nullptr
+                        );
+                    }
+                });
+
+                m_engine->currentScene()->onFixedUpdate(stepDuration);
+            }
+
+            m_engine->currentScene()->setInterpolationAlpha(fixedTimestep.alpha());
         }
     }
 }
@@ -136,6 +168,28 @@ void Editor::onMenuBar(Project &project) {
                 }
             }
 
+            auto *scene = m_engine->currentScene();
+            auto isPhysicsThreaded = scene != nullptr && scene->isPhysicsThreaded();
+
+            if (ImGui::MenuItem("Physics thread", nullptr, isPhysicsThreaded, scene != nullptr)) {
+                scene->setPhysicsThreaded(!isPhysicsThreaded);
+
+                // Copied into the scene played next
+                if (m_scene != nullptr) {
+                    m_scene->setPhysicsThreaded(!isPhysicsThreaded);
+                }
+            }
+
+            ImGui::EndMenu();
+        }
+
+        if (ImGui::BeginMenu("Assets")) {
+            if (ImGui::MenuItem("Build atlases")) {
+                AtlasBuilder::build(project.assetsDirectoryPath());
+
+                m_assetManager->loadMappings(project.assetsDirectoryPath());
+            }
+
             ImGui::EndMenu();
         }
 
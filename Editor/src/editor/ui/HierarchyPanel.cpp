@@ -8,52 +8,28 @@ void HierarchyPanel::onUpdate() {
 
         if (ImGui::BeginPopupContextWindow("hierarchy_context_menu", 1)) {
             if (ImGui::MenuItem("Create entity")) {
-                auto &entities = scene->entities();
-
-                std::optional<size_t> selectedEntityIndex = std::nullopt;
-
-                if (m_selectedEntity != nullptr) {
-                    for (size_t i = 0; i < entities.size(); i++) {
-                        if (*m_selectedEntity == entities[i]) {
-                            selectedEntityIndex = std::make_optional(i);
-                        }
-                    }
-                }
-
                 scene->create();
-
-                if (selectedEntityIndex.has_value()) {
-                    m_selectedEntity = &entities[selectedEntityIndex.value()];
-                }
             }
 
             ImGui::EndPopup();
         }
 
-        auto &entities = scene->entities();
-
-        std::optional<size_t> entityToDestroyIndex = {};
-
-        for (size_t i = 0; i < entities.size(); i++) {
-            auto &entity = entities[i];
+        std::optional<Entity> entityToDestroy = {};
 
+        for (auto entity : scene->entities()) {
             auto destroy = entityHierarchy(entity);
 
             if (destroy) {
-                entityToDestroyIndex = std::make_optional(i);
+                entityToDestroy = std::make_optional(entity);
             }
         }
 
-        if (entityToDestroyIndex.has_value()) {
-            if (m_selectedEntity == &entities[entityToDestroyIndex.value()]) {
-                m_selectedEntity = nullptr;
-            }
-
-            scene->remove(entities[entityToDestroyIndex.value()]);
+        if (entityToDestroy.has_value()) {
+            scene->remove(entityToDestroy.value());
         }
 
         if (ImGui::IsWindowHovered() && ImGui::IsMouseDown(0)) {
-            m_selectedEntity = nullptr;
+            m_selectedEntity = std::nullopt;
         }
     }
 
@@ -67,28 +43,12 @@ bool HierarchyPanel::entityHierarchy(Entity &entity) {
     auto destroy = false;
 
     if (ImGui::IsItemClicked()) {
-        m_selectedEntity = &entity;
+        m_selectedEntity = std::make_optional(entity);
     }
 
     if (ImGui::BeginPopupContextItem()) {
         if (ImGui::MenuItem("Create entity")) {
-            auto &children = entity.children();
-
-            std::optional<size_t> selectedEntityIndex = std::nullopt;
-
-            if (m_selectedEntity != nullptr) {
-                for (size_t i = 0; i < children.size(); i++) {
-                    if (*m_selectedEntity == children[i]) {
-                        selectedEntityIndex = std::make_optional(i);
-                    }
-                }
-            }
-
             entity.createChild();
-
-            if (selectedEntityIndex.has_value()) {
-                m_selectedEntity = &children[selectedEntityIndex.value()];
-            }
         }
 
         if (ImGui::MenuItem("Delete entity")) {
@@ -99,26 +59,18 @@ bool HierarchyPanel::entityHierarchy(Entity &entity) {
     }
 
     if (isOpen) {
-        auto &children = entity.children();
-
-        std::optional<size_t> entityToDestroyIndex = {};
-
-        for (size_t i = 0; i < children.size(); i++) {
-            auto &child = children[i];
+        std::optional<Entity> entityToDestroy = {};
 
+        for (auto child : entity.children()) {
             auto destroyChild = entityHierarchy(child);
 
             if (destroyChild) {
-                entityToDestroyIndex = std::make_optional(i);
+                entityToDestroy = std::make_optional(child);
             }
         }
 
-        if (entityToDestroyIndex.has_value()) {
-            if (m_selectedEntity == &children[entityToDestroyIndex.value()]) {
-                m_selectedEntity = nullptr;
-            }
-
-            entity.removeChild(children[entityToDestroyIndex.value()]);
+        if (entityToDestroy.has_value()) {
+            entity.removeChild(entityToDestroy.value());
         }
 
         ImGui::TreePop();
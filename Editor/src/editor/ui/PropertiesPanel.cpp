@@ -19,11 +19,20 @@ void PropertiesPanel::onUpdate() {
                 }
 
                 if (selectedEntity->hasComponent<TransformComponent>()) {
-                    auto &transform = selectedEntity->getComponent<TransformComponent>();
+                    auto transform = selectedEntity->getComponent<TransformComponent>();
 
-                    ImGui::DragFloat2("Position", glm::value_ptr(transform.position), 0.1f, 0.0f, 0.0f, "%.5f");
-                    ImGui::DragFloat("Rotation", &transform.rotation, 0.1f, 0.0f, 0.0f, "%.5f");
-                    ImGui::DragFloat2("Scale", glm::value_ptr(transform.scale), 0.1f, 0.0f, 0.0f, "%.5f");
+                    bool isChanged = false;
+
+                    isChanged |=
+                        ImGui::DragFloat2("Position", glm::value_ptr(transform.position), 0.1f, 0.0f, 0.0f, "%.5f");
+                    isChanged |= ImGui::DragFloat("Rotation", &transform.rotation, 0.1f, 0.0f, 0.0f, "%.5f");
+                    isChanged |= ImGui::DragFloat2("Scale", glm::value_ptr(transform.scale), 0.1f, 0.0f, 0.0f, "%.5f");
+
+                    if (isChanged) {
+                        selectedEntity->patchComponent<TransformComponent>([&](auto &patchedTransform) {
+                            patchedTransform = transform;
+                        });
+                    }
                 }
             }
         }
@@ -39,10 +48,17 @@ void PropertiesPanel::onUpdate() {
                 }
 
                 if (selectedEntity->hasComponent<SpriteComponent>()) {
-                    auto &sprite = selectedEntity->getComponent<SpriteComponent>();
+                    auto sprite = selectedEntity->getComponent<SpriteComponent>();
+
+                    bool isChanged = false;
 
                     if (sprite.texture != nullptr) {
-                        ImGui::Image(sprite.texture->view(), ImVec2(128.0f, 128.0f), ImVec2(0, 1), ImVec2(1, 0));
+                        auto uvRect = sprite.texture->uvRect();
+
+                        ImGui::Image(
+                            sprite.texture->view(), ImVec2(128.0f, 128.0f), ImVec2(uvRect.x, uvRect.y + uvRect.w),
+                            ImVec2(uvRect.x + uvRect.z, uvRect.y)
+                        );
                     } else {
                         ImGui::Image(m_emptyTexture->view(), ImVec2(128.0f, 128.0f), ImVec2(0, 1), ImVec2(1, 0));
                     }
@@ -60,10 +76,21 @@ void PropertiesPanel::onUpdate() {
                             auto texture = m_assetManager->getTextureById(m_assetManager->getIdByPath(path));
 
                             sprite.texture = texture;
+                            isChanged = true;
                         }
 
                         ImGui::EndDragDropTarget();
                     }
+
+                    isChanged |= ImGui::DragInt("Sorting layer", &sprite.sortingLayer, 0.1f, INT8_MIN, INT8_MAX);
+                    isChanged |= ImGui::DragInt("Order in layer", &sprite.orderInLayer, 0.1f, INT16_MIN, INT16_MAX);
+                    isChanged |= ImGui::Checkbox("Static", &sprite.isStatic);
+
+                    if (isChanged) {
+                        selectedEntity->patchComponent<SpriteComponent>([&](auto &patchedSprite) {
+                            patchedSprite = sprite;
+                        });
+                    }
                 }
             }
         }
@@ -0,0 +1,86 @@
+#include "editor/ui/StatisticsPanel.hpp"
+
+#include <array>
+
+struct PresentModeOption {
+        WGPUPresentMode presentMode;
+        const char *name;
+};
+
+static constexpr std::array<PresentModeOption, 3> s_presentModeOptions = { {
+    { WGPUPresentMode_Fifo, "Fifo" },
+    { WGPUPresentMode_Mailbox, "Mailbox" },
+    { WGPUPresentMode_Immediate, "Immediate" },
+} };
+
+static const char *presentModeName(WGPUPresentMode presentMode) {
+    for (const auto &option : s_presentModeOptions) {
+        if (option.presentMode == presentMode) {
+            return option.name;
+        }
+    }
+
+    return "Unknown";
+}
+
+void StatisticsPanel::onUpdate(const Renderer &renderer, GraphicsBackend &graphicsBackend, float deltaTime) {
+    ImGui::Begin("Statistics");
+
+    const auto &statistics = renderer.statistics();
+
+    ImGui::Text("Frame time: %.3f ms", deltaTime * 1000.0f);
+
+    auto &framePacer = graphicsBackend.framePacer();
+    const auto &pacingStatistics = framePacer.statistics();
+
+    ImGui::Text("CPU wait: %.3f ms", pacingStatistics.cpuWaitMilliseconds);
+    ImGui::Text("GPU latency: %.3f ms", pacingStatistics.gpuLatencyMilliseconds);
+    ImGui::Text("Frames in flight: %u", pacingStatistics.framesInFlight);
+
+    auto maxFramesInFlight = static_cast<int>(framePacer.maxFramesInFlight());
+
+    if (ImGui::SliderInt("Max frames in flight", &maxFramesInFlight, 1, FramePacer::s_maxFramesInFlight)) {
+        framePacer.setMaxFramesInFlight(static_cast<uint32_t>(maxFramesInFlight));
+    }
+
+    if (ImGui::BeginCombo("Present mode", presentModeName(graphicsBackend.presentMode()))) {
+        for (const auto &option : s_presentModeOptions) {
+            if (!graphicsBackend.isPresentModeSupported(option.presentMode))
+                continue;
+
+            if (ImGui::Selectable(option.name, graphicsBackend.presentMode() == option.presentMode)) {
+                graphicsBackend.setPresentMode(option.presentMode);
+            }
+        }
+
+        ImGui::EndCombo();
+    }
+
+    ImGui::Separator();
+
+    ImGui::Text("Render passes: %u", statistics.renderPasses);
+    ImGui::Text("Draw calls: %u", statistics.drawCalls);
+    ImGui::Text("Render bundles: %u", statistics.renderBundles);
+    ImGui::Text("Sprites: %u", statistics.sprites);
+    ImGui::Text("Static sprites: %u", statistics.staticSprites);
+    ImGui::Text("Culled sprites: %u", statistics.culledSprites);
+    ImGui::Text("Created GPU objects: %u", statistics.createdGpuObjects);
+
+    auto *gpuProfiler = renderer.profiler();
+
+    if (gpuProfiler != nullptr) {
+        ImGui::Separator();
+
+        bool isEnabled = gpuProfiler->isEnabled();
+
+        if (ImGui::Checkbox("GPU profiling", &isEnabled)) {
+            gpuProfiler->setEnabled(isEnabled);
+        }
+
+        for (const auto &timing : gpuProfiler->timings()) {
+            ImGui::Text("%s: %.3f ms", timing.name.c_str(), timing.milliseconds);
+        }
+    }
+
+    ImGui::End();
+}
@@ -33,6 +33,7 @@ void ViewportPanel::onUpdate(Project &project, std::shared_ptr<Texture2D> &viewp
         if (!isPlaying) {
             m_engine->setCurrentScene(std::make_shared<Scene>(Scene::copy(*m_editor.scene())));
             m_engine->currentScene()->start();
+            m_engine->fixedTimestep().reset();
 
             {
                 m_scriptEngine->setup();
@@ -89,6 +90,10 @@ void ViewportPanel::onUpdate(Project &project, std::shared_ptr<Texture2D> &viewp
                 m_scriptEngine->setInternalCall("DelusionSharp.Internals::GetBoxColliderOffset", &getBoxColliderOffset);
                 m_scriptEngine->setInternalCall("DelusionSharp.Internals::SetBoxColliderOffset", &setBoxColliderOffset);
 
+                m_scriptEngine->setInternalCall("DelusionSharp.Internals::QueryOverlaps", &queryOverlaps);
+                m_scriptEngine->setInternalCall("DelusionSharp.Internals::Raycast", &raycast);
+                m_scriptEngine->setInternalCall("DelusionSharp.Internals::BoxCast", &boxCast);
+
                 auto delusionSharpLibraryPath = std::filesystem::current_path() / "DelusionSharp.dll";
                 auto delusionSharpLibraryPathString = delusionSharpLibraryPath.string();
 
@@ -145,11 +150,7 @@ void ViewportPanel::onUpdate(Project &project, std::shared_ptr<Texture2D> &viewp
             if (selectedEntityId.has_value()) {
                 auto entity = m_engine->currentScene()->getById(selectedEntityId.value());
 
-                if (entity.has_value()) {
-                    m_hierarchyPanel.setSelectedEntity(entity.value());
-                } else {
-                    m_hierarchyPanel.setSelectedEntity(nullptr);
-                }
+                m_hierarchyPanel.setSelectedEntity(entity);
             }
         } else {
             m_scriptEngine->teardown();
@@ -160,11 +161,7 @@ void ViewportPanel::onUpdate(Project &project, std::shared_ptr<Texture2D> &viewp
             if (selectedEntityId.has_value()) {
                 auto entity = m_engine->currentScene()->getById(selectedEntityId.value());
 
-                if (entity.has_value()) {
-                    m_hierarchyPanel.setSelectedEntity(entity.value());
-                } else {
-                    m_hierarchyPanel.setSelectedEntity(nullptr);
-                }
+                m_hierarchyPanel.setSelectedEntity(entity);
             }
         }
 
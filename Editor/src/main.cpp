@@ -1,4 +1,5 @@
 #include <memory>
+#include <optional>
 
 #include <imgui.h>
 #include <imgui_impl_glfw.h>
@@ -8,6 +9,7 @@
 
 #include <delusion/Engine.hpp>
 #include <delusion/formats/ImageDecoder.hpp>
+#include <delusion/graphics/GpuProfiler.hpp>
 #include <delusion/graphics/GraphicsBackend.hpp>
 #include <delusion/graphics/Renderer.hpp>
 #include <delusion/scripting/ScriptEngine.hpp>
@@ -25,7 +27,7 @@ int main() {
 
     auto backend = std::make_shared<GraphicsBackend>();
 
-    auto window = std::make_shared<Window>("", defaultWindowWidth, defaultWindowHeight);
+    auto window = engine->createWindow("", defaultWindowWidth, defaultWindowHeight);
 
     engine->setCurrentWindow(window);
 
@@ -51,6 +53,15 @@ int main() {
 
     Renderer renderer = Renderer::create(backend->device(), backend->queue(), backend->surfaceCapabilities());
 
+    // Disabled until turned on from the statistics panel
+    std::unique_ptr<GpuProfiler> gpuProfiler;
+
+    if (backend->hasTimestampQueries()) {
+        gpuProfiler = GpuProfiler::create(backend->device());
+
+        renderer.setGpuProfiler(gpuProfiler.get());
+    }
+
     auto scriptEngine = std::make_shared<ScriptEngine>();
 
     auto fileIconImage = ImageDecoder::decode("file.png");
@@ -95,28 +106,48 @@ int main() {
 
         editor.onRuntimeUpdate(deltaTime);
 
-        WGPUSurfaceTexture surfaceTexture;
-        wgpuSurfaceGetCurrentTexture(backend->surface(), &surfaceTexture);
+        // Nothing can be presented while minimized, waiting for events keeps the loop from spinning
+        if (currentWidth == 0 || currentHeight == 0) {
+            engine->waitEvents();
 
-        if (surfaceTexture.status != WGPUSurfaceGetCurrentTextureStatus_Success) {
             continue;
         }
 
         if (currentWidth != previousWidth || currentHeight != previousHeight) {
-            if (currentWidth > 0 && currentHeight > 0) {
-                backend->configureSurface(static_cast<uint32_t>(currentWidth), static_cast<uint32_t>(currentHeight));
-            }
+            backend->configureSurface(static_cast<uint32_t>(currentWidth), static_cast<uint32_t>(currentHeight));
 
             previousWidth = currentWidth;
             previousHeight = currentHeight;
         }
 
+        backend->framePacer().beginFrame();
+
+        WGPUSurfaceTexture surfaceTexture;
+        wgpuSurfaceGetCurrentTexture(backend->surface(), &surfaceTexture);
+
+        if (surfaceTexture.status != WGPUSurfaceGetCurrentTextureStatus_Success) {
+            if (surfaceTexture.texture != nullptr) {
+                wgpuTextureRelease(surfaceTexture.texture);
+            }
+
+            // Outdated or lost, it has to be configured again before the next attempt
+            if (surfaceTexture.status != WGPUSurfaceGetCurrentTextureStatus_Timeout) {
+                backend->configureSurface(static_cast<uint32_t>(currentWidth), static_cast<uint32_t>(currentHeight));
+            }
+
+            continue;
+        }
+
         WGPUCommandEncoderDescriptor encoderDescriptor = {
             .nextInChain = nullptr,
             .label = "Command encoder",
         };
         WGPUCommandEncoder commandEncoder = wgpuDeviceCreateCommandEncoder(backend->device(), &encoderDescriptor);
 
+        if (gpuProfiler != nullptr) {
+            gpuProfiler->beginFrame();
+        }
+
         {
             auto *scene = engine->currentScene();
 
@@ -132,7 +163,7 @@ int main() {
 
             ImGui::DockSpaceOverViewport(ImGui::GetMainViewport());
 
-            editor.onEditorUpdate(viewportTexture, deltaTime);
+            editor.onEditorUpdate(viewportTexture, renderer, deltaTime);
 
             ImGui::Render();
         }
@@ -146,12 +177,18 @@ int main() {
             .storeOp = WGPUStoreOp_Store,
             .clearValue = WGPUColor { 0.3, 0.3, 0.3, 1.0 },
         };
+        std::optional<WGPURenderPassTimestampWrites> timestampWrites;
+
+        if (gpuProfiler != nullptr) {
+            timestampWrites = gpuProfiler->timestampWrites("Editor UI");
+        }
+
         WGPURenderPassDescriptor renderPassDescriptor = {
             .nextInChain = nullptr,
             .colorAttachmentCount = 1,
             .colorAttachments = &renderPassColorAttachment,
             .depthStencilAttachment = nullptr,
-            .timestampWrites = nullptr,
+            .timestampWrites = timestampWrites.has_value() ? &timestampWrites.value() : nullptr,
         };
         WGPURenderPassEncoder renderPassEncoder =
             wgpuCommandEncoderBeginRenderPass(commandEncoder, &renderPassDescriptor);
@@ -160,15 +197,25 @@ int main() {
 
         wgpuRenderPassEncoderEnd(renderPassEncoder);
 
+        if (gpuProfiler != nullptr) {
+            gpuProfiler->resolve(commandEncoder);
+        }
+
         WGPUCommandBufferDescriptor commandBufferDescriptor = {
             .nextInChain = nullptr,
             .label = "Command buffer",
         };
         WGPUCommandBuffer commandBuffer = wgpuCommandEncoderFinish(commandEncoder, &commandBufferDescriptor);
 
-        wgpuQueueSubmit(backend->queue(), 1, &commandBuffer);
+        auto submissionIndex = wgpuQueueSubmitForIndex(backend->queue(), 1, &commandBuffer);
         wgpuSurfacePresent(backend->surface());
 
+        backend->framePacer().endFrame(submissionIndex);
+
+        if (gpuProfiler != nullptr) {
+            gpuProfiler->endFrame();
+        }
+
         wgpuCommandBufferReference(commandBuffer);
         wgpuRenderPassEncoderRelease(renderPassEncoder);
         wgpuCommandEncoderRelease(commandEncoder);
@@ -1,33 +1,57 @@
-struct VertexInput {
+struct InstanceInput {
     @location(0) position: vec2f,
-    @location(1) uv: vec2f,
+    @location(1) scale: vec2f,
+    @location(2) rotation: f32,
+    @location(3) layer: u32,
+    @location(4) uvRect: vec4f,
 }
 
 struct VertexOutput {
     @builtin(position) position: vec4f,
     @location(0) uv: vec2f,
+    @location(1) @interpolate(flat) layer: u32,
 }
 
 struct Uniforms {
-    transformMatrix: mat4x4<f32>,
     viewProjectionMatrix: mat4x4<f32>,
 }
 
-@group(0) @binding(0) var texture: texture_2d<f32>;
-@group(0) @binding(1) var textureSampler: sampler;
-@group(0) @binding(2) var<uniform> uniforms: Uniforms;
+@group(0) @binding(0) var<uniform> uniforms: Uniforms;
+
+@group(1) @binding(0) var texture: texture_2d_array<f32>;
+@group(1) @binding(1) var textureSampler: sampler;
 
 @vertex
-fn vs_main(in: VertexInput) -> VertexOutput {
+fn vs_main(@builtin(vertex_index) vertexIndex: u32, instance: InstanceInput) -> VertexOutput {
     var out: VertexOutput;
 
-    out.position = uniforms.viewProjectionMatrix * uniforms.transformMatrix * vec4f(in.position.x, in.position.y, 0.0, 1.0);
-    out.uv = in.uv;
+    // Unit quad centered at the origin, as two triangles
+    var corners = array<vec2f, 6>(
+        vec2f(0.5, 0.5),
+        vec2f(0.5, -0.5),
+        vec2f(-0.5, 0.5),
+        vec2f(0.5, -0.5),
+        vec2f(-0.5, -0.5),
+        vec2f(-0.5, 0.5),
+    );
+
+    let corner = corners[vertexIndex];
+
+    // Scale, then rotate clockwise by the rotation, then translate
+    let scaled = corner * instance.scale;
+    let c = cos(instance.rotation);
+    let s = sin(instance.rotation);
+    let rotated = vec2f(scaled.x * c + scaled.y * s, -scaled.x * s + scaled.y * c);
+    let worldPosition = rotated + instance.position;
+
+    out.position = uniforms.viewProjectionMatrix * vec4f(worldPosition, 0.0, 1.0);
+    out.uv = instance.uvRect.xy + (corner + vec2f(0.5, 0.5)) * instance.uvRect.zw;
+    out.layer = instance.layer;
 
     return out;
 }
 
 @fragment
 fn fs_main(in: VertexOutput) -> @location(0) vec4f {
-    return textureSample(texture, textureSampler, in.uv).rgba;
+    return textureSample(texture, textureSampler, in.uv, in.layer).rgba;
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <filesystem>
+#include <limits>
 #include <unordered_map>
 
 #include "delusion/audio/AudioClip.hpp"
@@ -20,6 +21,35 @@ class AssetManager {
 
         std::unordered_map<UniqueId, std::shared_ptr<Texture2D>> m_textures;
         std::unordered_map<UniqueId, std::shared_ptr<AudioClip>> m_audioClips;
+
+        [[nodiscard]] static Metadata readMetadata(const std::filesystem::path &assetPath) {
+            auto metadataPath = assetPath;
+
+            metadataPath.replace_extension(std::format("{}.{}", metadataPath.extension().string(), "metadata"));
+
+            auto metadataContent = readAsString(metadataPath);
+
+            return MetadataSerde::deserialize(metadataContent.value());
+        }
+
+        [[nodiscard]] std::shared_ptr<Texture2D> loadTexture(
+            const std::filesystem::path &assetPath, const Metadata &metadata
+        ) {
+            // Images packed by the atlas builder are sampled from their page instead of being uploaded on their own
+            if (metadata.atlasRegion.has_value() && m_idToPathMappings.contains(metadata.atlasRegion->page)) {
+                auto pageId = metadata.atlasRegion->page;
+
+                loadAsset(pageId);
+
+                return Texture2D::createRegion(metadata.id, m_textures.at(pageId), metadata.atlasRegion->uvRect);
+            }
+
+            auto image = ImageDecoder::decode(assetPath.string());
+
+            auto maxMipLevelCount = metadata.mipLevelCount.value_or(std::numeric_limits<uint32_t>::max());
+
+            return Texture2D::create(metadata.id, m_device, m_queue, image, maxMipLevelCount);
+        }
     public:
         AssetManager(WGPUDevice device, WGPUQueue queue) : m_device(device), m_queue(queue) {}
 
@@ -38,19 +68,11 @@ class AssetManager {
         }
 
         UniqueId loadAsset(const std::filesystem::path &assetPath) {
-            auto metadataPath = assetPath;
-
-            metadataPath.replace_extension(std::format("{}.{}", metadataPath.extension().string(), "metadata"));
-
-            auto metadataContent = readAsString(metadataPath);
-
-            Metadata metadata = MetadataSerde::deserialize(metadataContent.value());
+            Metadata metadata = readMetadata(assetPath);
 
             if (assetPath.extension() == ".png") {
                 if (!m_textures.contains(metadata.id)) {
-                    auto image = ImageDecoder::decode(assetPath.string());
-
-                    m_textures[metadata.id] = Texture2D::create(metadata.id, m_device, m_queue, image);
+                    m_textures[metadata.id] = loadTexture(assetPath, metadata);
                     m_idToPathMappings[metadata.id] = assetPath;
                 }
             } else if (assetPath.extension() == ".mp3") {
@@ -68,9 +90,7 @@ class AssetManager {
 
             if (assetPath.extension() == ".png") {
                 if (!m_textures.contains(id)) {
-                    auto image = ImageDecoder::decode(assetPath.string());
-
-                    m_textures[id] = Texture2D::create(id, m_device, m_queue, image);
+                    m_textures[id] = loadTexture(assetPath, readMetadata(assetPath));
                 }
             } else if (assetPath.extension() == ".mp3") {
                 if (!m_audioClips.contains(id)) {
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <filesystem>
+
+// Offline import step packing groups of small images into atlas pages.
+//
+// Images are grouped by the atlas tag in their metadata, images in a directory containing an `.atlas` file are tagged
+// with the directory's name by default. Every group is packed into as few pages as possible, pages are written as
+// regular png assets to `<rootPath>/atlases` and the page and UV rect of every image are recorded in its metadata.
+// Pages only get the few mip levels the padding between images covers.
+class AtlasBuilder {
+    public:
+        static void build(const std::filesystem::path &rootPath, uint32_t maxPageSize = 2048);
+};
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <glm/vec2.hpp>
+
+// Axis-aligned bounding box in world space.
+struct BoundingBox {
+        glm::vec2 min;
+        glm::vec2 max;
+
+        [[nodiscard]] bool intersects(const BoundingBox &other) const {
+            return min.x <= other.max.x && max.x >= other.min.x && min.y <= other.max.y && max.y >= other.min.y;
+        }
+};
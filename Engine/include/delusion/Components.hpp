@@ -2,6 +2,7 @@
 
 #include <memory>
 
+#include <glm/mat3x3.hpp>
 #include <glm/vec2.hpp>
 
 #include "delusion/graphics/Texture2D.hpp"
@@ -19,8 +20,40 @@ struct TransformComponent {
             : position(position), scale(scale), rotation(rotation) {}
 };
 
+// Transform relative to the world, derived from the entity's TransformComponent and the ones of its parents.
+// Added and kept up to date by Scene::updateWorldTransforms(), don't modify it directly.
+struct WorldTransformComponent {
+        glm::mat3 matrix = glm::mat3(1.0f);
+
+        // Composed separately rather than extracted from the matrix, so they're exact for entities without parents.
+        // Shear introduced by rotated, non-uniformly scaled parents can't be represented and is lost.
+        glm::vec2 position = glm::vec2(0.0f, 0.0f);
+        glm::vec2 scale = glm::vec2(1.0f, 1.0f);
+        float rotation = 0.0f;
+
+        // Of the closest parent with a transform (identity for roots), to map world space changes back to local space.
+        glm::mat3 parentMatrix = glm::mat3(1.0f);
+        float parentRotation = 0.0f;
+};
+
+// World transform of a moving rigidbody before the last step's results were written back, sprites are drawn between it
+// and the current one. Maintained by Scene::onFixedUpdate(), only present while the body is awake.
+struct PreviousWorldTransformComponent {
+        glm::vec2 position = glm::vec2(0.0f, 0.0f);
+        float rotation = 0.0f;
+};
+
 struct SpriteComponent {
         std::shared_ptr<Texture2D> texture;
+
+        // Sprites are drawn by ascending sorting layer, then by ascending order within the layer.
+        // Layers range from -128 to 127 and orders from -32768 to 32767, anything outside is clamped.
+        int32_t sortingLayer = 0;
+        int32_t orderInLayer = 0;
+
+        // Static sprites are expected to rarely change, the renderer records them once and replays the recording.
+        // They're sorted along with every other sprite, drawn first among sprites with the same layer and order.
+        bool isStatic = false;
 };
 
 struct RigidbodyComponent {
@@ -40,7 +73,8 @@ struct RigidbodyComponent {
 
         RigidbodyComponent() = default;
 
-        RigidbodyComponent(RigidbodyComponent &other) {
+        // Copies only the settings, a copy gets its own body once simulated.
+        RigidbodyComponent(const RigidbodyComponent &other) {
             bodyType = other.bodyType;
             hasFixedRotation = other.hasFixedRotation;
             density = other.density;
@@ -48,6 +82,11 @@ struct RigidbodyComponent {
             restitution = other.restitution;
             restitutionThreshold = other.restitutionThreshold;
         }
+
+        // Moves keep the body, the registry moves components around within their pool (e.g. for groups).
+        RigidbodyComponent(RigidbodyComponent &&other) noexcept = default;
+
+        RigidbodyComponent &operator=(RigidbodyComponent &&other) noexcept = default;
     private:
         void *body {};
         void *fixture {};
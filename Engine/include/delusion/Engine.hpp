@@ -3,10 +3,12 @@
 #include <cassert>
 #include <iostream>
 #include <memory>
+#include <string>
 
 #include <glfw/glfw3.h>
 
 #include "delusion/AssetManager.hpp"
+#include "delusion/FixedTimestep.hpp"
 #include "delusion/graphics/GraphicsBackend.hpp"
 #include "delusion/Scene.hpp"
 #include "delusion/Window.hpp"
@@ -22,16 +24,17 @@ class Engine {
         std::shared_ptr<Window> m_currentWindow;
         std::shared_ptr<Scene> m_currentScene;
 
-        Engine() {
-            if (glfwInit() != GLFW_TRUE) {
-                throw std::exception("GLFW initialization failed");
-            }
+        FixedTimestep m_fixedTimestep;
 
-            glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-        }
+        // GLFW is only initialized along with the first window, headless runs (tests, benchmarks...) never need it.
+        bool m_isWindowingInitialized = false;
+
+        Engine() = default;
     public:
         ~Engine() {
-            glfwTerminate();
+            if (m_isWindowingInitialized) {
+                glfwTerminate();
+            }
         }
 
         static Engine *get() {
@@ -58,6 +61,20 @@ class Engine {
             m_assetManager = std::move(assetManager);
         }
 
+        [[nodiscard]] std::shared_ptr<Window> createWindow(const std::string &title, uint32_t width, uint32_t height) {
+            if (!m_isWindowingInitialized) {
+                if (glfwInit() != GLFW_TRUE) {
+                    throw std::exception("GLFW initialization failed");
+                }
+
+                glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+
+                m_isWindowingInitialized = true;
+            }
+
+            return std::make_shared<Window>(title, width, height);
+        }
+
         [[nodiscard]] Window *currentWindow() const {
             return m_currentWindow.get();
         }
@@ -74,7 +91,21 @@ class Engine {
             m_currentScene = std::move(scene);
         }
 
+        // Paces the simulation of the current scene.
+        [[nodiscard]] FixedTimestep &fixedTimestep() {
+            return m_fixedTimestep;
+        }
+
         void pollEvents() {
-            glfwPollEvents();
+            if (m_isWindowingInitialized) {
+                glfwPollEvents();
+            }
+        }
+
+        // Blocks until at least one event arrives, for when there's nothing to render (e.g. a minimized window).
+        void waitEvents() {
+            if (m_isWindowingInitialized) {
+                glfwWaitEvents();
+            }
         }
 };
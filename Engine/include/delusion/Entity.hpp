@@ -1,94 +1,128 @@
 #pragma once
 
-#include <span>
-
 #include <entt/entt.hpp>
 
 #include "delusion/UniqueId.hpp"
 
 class Scene;
 
-class Entity {
-    private:
-        entt::registry *m_registry;
-        entt::entity m_entityId;
+// Lets the scene look an entity up by its id.
+struct IdComponent {
+        UniqueId id;
+};
 
-        UniqueId m_id;
+// Place of an entity in the scene hierarchy. Siblings form a doubly linked list in creation order, so entities are
+// added and removed in constant time and the hierarchy needs no allocations of its own.
+struct HierarchyComponent {
+        entt::entity parent { entt::null };
+        entt::entity firstChild { entt::null };
+        entt::entity lastChild { entt::null };
+        entt::entity previousSibling { entt::null };
+        entt::entity nextSibling { entt::null };
+};
 
-        std::vector<Entity> m_children;
+// Handle to an entity of a scene, cheap to copy and never invalidated by other entities being created or removed.
+// Handles taken before moving a scene keep referring to the moved-from registry.
+class Entity {
+    private:
+        entt::registry *m_registry {};
+        entt::entity m_entityId { entt::null };
     public:
-        Entity(entt::registry *registry, const entt::entity entityId)
-            : m_registry(registry), m_entityId(entityId), m_id(UniqueId()) {}
-
-        Entity(entt::registry *registry, const entt::entity entityId, UniqueId id)
-            : m_registry(registry), m_entityId(entityId), m_id(id) {}
-
-        // TODO: Implement
-        Entity(const Entity &other) = delete;
-
-        Entity(Entity &&other) noexcept {
-            m_registry = std::exchange(other.m_registry, nullptr);
-            m_entityId = std::exchange(other.m_entityId, entt::null);
-            m_id = std::exchange(other.m_id, UniqueId(0));
-            m_children = std::move(other.m_children);
+        class ChildIterator {
+            private:
+                entt::registry *m_registry;
+                entt::entity m_entityId;
+            public:
+                ChildIterator(entt::registry *registry, entt::entity entityId)
+                    : m_registry(registry), m_entityId(entityId) {}
+
+                [[nodiscard]] Entity operator*() const {
+                    return { m_registry, m_entityId };
+                }
+
+                ChildIterator &operator++() {
+                    m_entityId = m_registry->get<HierarchyComponent>(m_entityId).nextSibling;
+
+                    return *this;
+                }
+
+                [[nodiscard]] bool operator==(const ChildIterator &other) const {
+                    return m_entityId == other.m_entityId;
+                }
+
+                [[nodiscard]] bool operator!=(const ChildIterator &other) const {
+                    return m_entityId != other.m_entityId;
+                }
+        };
+
+        // Children of an entity in creation order. Removing the child an iterator points at invalidates it.
+        class Children {
+            private:
+                entt::registry *m_registry;
+                entt::entity m_firstChild;
+            public:
+                Children(entt::registry *registry, entt::entity firstChild)
+                    : m_registry(registry), m_firstChild(firstChild) {}
+
+                [[nodiscard]] ChildIterator begin() const {
+                    return { m_registry, m_firstChild };
+                }
+
+                [[nodiscard]] ChildIterator end() const {
+                    return { m_registry, entt::null };
+                }
+
+                [[nodiscard]] bool empty() const {
+                    return m_firstChild == entt::null;
+                }
+        };
+
+        Entity() = default;
+
+        Entity(entt::registry *registry, const entt::entity entityId) : m_registry(registry), m_entityId(entityId) {}
+
+        [[nodiscard]] bool operator==(const Entity &other) const noexcept {
+            return m_registry == other.m_registry && m_entityId == other.m_entityId;
         }
 
-        ~Entity() {
-            if (m_entityId != entt::null) {
-                m_registry->destroy(m_entityId);
-            }
+        [[nodiscard]] bool operator!=(const Entity &other) const noexcept {
+            return m_registry != other.m_registry || m_entityId != other.m_entityId;
         }
 
-        // TODO: Implement
-        Entity &operator=(const Entity &other) = delete;
-
-        Entity &operator=(Entity &&other) noexcept {
-            if (m_entityId != entt::null) {
-                m_registry->destroy(m_entityId);
-            }
-
-            m_registry = std::exchange(other.m_registry, nullptr);
-            m_entityId = std::exchange(other.m_entityId, entt::null);
-            m_id = std::exchange(other.m_id, UniqueId(0));
-            m_children = std::move(other.m_children);
-
-            return *this;
-        }
-
-        [[nodiscard]] bool operator==(const Entity &other) noexcept {
-            return &m_registry == &other.m_registry && m_entityId == other.m_entityId;
-        }
-
-        [[nodiscard]] bool operator!=(const Entity &other) noexcept {
-            return &m_registry != &other.m_registry || m_entityId != other.m_entityId;
+        // False for default constructed handles and handles to removed entities.
+        [[nodiscard]] bool isValid() const {
+            return m_registry != nullptr && m_registry->valid(m_entityId);
         }
 
         [[nodiscard]] UniqueId id() const {
-            return m_id;
+            return m_registry->get<IdComponent>(m_entityId).id;
         }
 
-        Entity &createChild() {
+        Entity createChild() {
             auto entityId = m_registry->create();
 
-            m_children.emplace_back(m_registry, entityId);
+            m_registry->emplace<IdComponent>(entityId, UniqueId());
+            m_registry->emplace<HierarchyComponent>(entityId);
+
+            link(entityId);
 
-            return m_children.back();
+            return { m_registry, entityId };
         }
 
-        void removeChild(Entity &entity) {
-            auto result = std::find(m_children.begin(), m_children.end(), entity);
+        // Removes the child along with all of its descendants.
+        void removeChild(Entity entity) {
+            if (entity.m_registry != m_registry || !entity.isValid())
+                return;
 
-            if (result != m_children.end()) {
-                m_children.erase(result);
-            }
-        }
+            if (m_registry->get<HierarchyComponent>(entity.m_entityId).parent != m_entityId)
+                return;
 
-        [[nodiscard]] std::vector<Entity> &children() {
-            return m_children;
+            entity.unlink();
+            entity.destroy();
         }
 
-        [[nodiscard]] const std::vector<Entity> &children() const {
-            return m_children;
+        [[nodiscard]] Children children() const {
+            return { m_registry, m_registry->get<HierarchyComponent>(m_entityId).firstChild };
         }
 
         template <typename T>
@@ -114,6 +148,17 @@ class Entity {
             m_registry->remove<T>(m_entityId);
         }
 
+        // Modifies the component through the given functions and notifies listeners (e.g. the scene's spatial index),
+        // use instead of writing to getComponent() when the change has to be observed.
+        template <typename T, typename... Functions>
+        void patchComponent(Functions &&...functions) {
+            if (!hasComponent<T>()) {
+                throw std::runtime_error("Entity doesn't have component");
+            }
+
+            m_registry->patch<T>(m_entityId, std::forward<Functions>(functions)...);
+        }
+
         template <typename T>
         T &getComponent() {
             if (!hasComponent<T>()) {
@@ -131,6 +176,59 @@ class Entity {
 
             return m_registry->get<T>(m_entityId);
         }
+    private:
+        // Appends the entity to the end of this entity's children.
+        void link(entt::entity entityId) {
+            auto &hierarchy = m_registry->get<HierarchyComponent>(m_entityId);
+            auto &childHierarchy = m_registry->get<HierarchyComponent>(entityId);
+
+            childHierarchy.parent = m_entityId;
+            childHierarchy.previousSibling = hierarchy.lastChild;
+
+            if (hierarchy.lastChild != entt::null) {
+                m_registry->get<HierarchyComponent>(hierarchy.lastChild).nextSibling = entityId;
+            } else {
+                hierarchy.firstChild = entityId;
+            }
+
+            hierarchy.lastChild = entityId;
+        }
+
+        void unlink() {
+            auto &hierarchy = m_registry->get<HierarchyComponent>(m_entityId);
+            auto &parentHierarchy = m_registry->get<HierarchyComponent>(hierarchy.parent);
+
+            if (hierarchy.previousSibling != entt::null) {
+                m_registry->get<HierarchyComponent>(hierarchy.previousSibling).nextSibling = hierarchy.nextSibling;
+            } else {
+                parentHierarchy.firstChild = hierarchy.nextSibling;
+            }
+
+            if (hierarchy.nextSibling != entt::null) {
+                m_registry->get<HierarchyComponent>(hierarchy.nextSibling).previousSibling = hierarchy.previousSibling;
+            } else {
+                parentHierarchy.lastChild = hierarchy.previousSibling;
+            }
+
+            hierarchy.parent = entt::null;
+            hierarchy.previousSibling = entt::null;
+            hierarchy.nextSibling = entt::null;
+        }
+
+        // Destroys the entity and its descendants, which don't have to be unlinked from each other first.
+        void destroy() {
+            auto child = m_registry->get<HierarchyComponent>(m_entityId).firstChild;
+
+            while (child != entt::null) {
+                auto nextSibling = m_registry->get<HierarchyComponent>(child).nextSibling;
+
+                Entity(m_registry, child).destroy();
+
+                child = nextSibling;
+            }
+
+            m_registry->destroy(m_entityId);
+        }
 
         friend Scene;
 };
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+// Turns variable frame times into a whole number of fixed length steps, so the simulation behaves the same at any
+// frame rate. Time left over is carried into the next frame, alpha() tells how far the frame is past the last step,
+// for drawing between the previous and current simulation state.
+//
+// At most maxStepsPerFrame steps run in a frame and any time beyond that is dropped, otherwise frames made slow by
+// simulating would have to simulate ever more (the spiral of death).
+class FixedTimestep {
+    private:
+        float m_stepDuration;
+        uint32_t m_maxStepsPerFrame;
+
+        float m_accumulator {};
+    public:
+        explicit FixedTimestep(float stepRate = 60.0f, uint32_t maxStepsPerFrame = 5)
+            : m_stepDuration(1.0f / stepRate), m_maxStepsPerFrame(maxStepsPerFrame) {}
+
+        // Adds the frame's time and returns how many steps to run for it.
+        [[nodiscard]] uint32_t advance(float deltaTime) {
+            m_accumulator += deltaTime;
+
+            uint32_t stepCount = 0;
+
+            while (m_accumulator >= m_stepDuration && stepCount < m_maxStepsPerFrame) {
+                m_accumulator -= m_stepDuration;
+                stepCount += 1;
+            }
+
+            if (m_accumulator >= m_stepDuration) {
+                m_accumulator = std::fmod(m_accumulator, m_stepDuration);
+            }
+
+            return stepCount;
+        }
+
+        // Forgets leftover time, e.g. when a simulation starts.
+        void reset() {
+            m_accumulator = 0.0f;
+        }
+
+        [[nodiscard]] float alpha() const {
+            return m_accumulator / m_stepDuration;
+        }
+
+        [[nodiscard]] float stepDuration() const {
+            return m_stepDuration;
+        }
+
+        [[nodiscard]] float stepRate() const {
+            return 1.0f / m_stepDuration;
+        }
+
+        void setStepRate(float stepRate) {
+            m_stepDuration = 1.0f / stepRate;
+        }
+
+        [[nodiscard]] uint32_t maxStepsPerFrame() const {
+            return m_maxStepsPerFrame;
+        }
+
+        void setMaxStepsPerFrame(uint32_t maxStepsPerFrame) {
+            m_maxStepsPerFrame = maxStepsPerFrame;
+        }
+};
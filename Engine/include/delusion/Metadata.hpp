@@ -1,7 +1,29 @@
 #pragma once
 
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include <glm/vec4.hpp>
+
 #include "delusion/UniqueId.hpp"
 
+struct AtlasRegion {
+        UniqueId page;
+
+        // Offset and size in the page's UV space.
+        glm::vec4 uvRect;
+};
+
 struct Metadata {
         UniqueId id;
+
+        // Images with the same tag get packed into the same atlas.
+        std::optional<std::string> atlas;
+
+        // Written by the atlas builder, where the image ended up.
+        std::optional<AtlasRegion> atlasRegion;
+
+        // Limits the mip chain generated for the image, the full chain is generated otherwise.
+        std::optional<uint32_t> mipLevelCount;
 };
@@ -1,20 +1,119 @@
 #pragma once
 
+#include <future>
 #include <optional>
+#include <span>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include <box2d/box2d.h>
 
+#include "delusion/BoundingBox.hpp"
+#include "delusion/collections/SpatialHashGrid.hpp"
+#include "delusion/Components.hpp"
 #include "delusion/Entity.hpp"
+#include "delusion/threading/ThreadPool.hpp"
+
+// Registry entity of every entity in a scene by id.
+struct EntityIndex {
+        std::unordered_map<UniqueId, entt::entity> entities;
+};
+
+// Entities whose transform has been added, changed or removed since world transforms were last updated.
+struct TransformTracking {
+        std::unordered_set<entt::entity> dirty;
+};
+
+// Pose of a moving body after a step.
+struct BodyState {
+        entt::entity entity;
+        b2Vec2 position;
+        float angle;
+};
+
+struct PhysicsTracking {
+        // Rigidbodies whose world transform has been changed outside of the simulation (e.g. by scripts or the
+        // editor) since they were last pushed into Box2D.
+        std::unordered_set<entt::entity> movedBodies;
+
+        // Set while the simulation's results are written back, so they aren't mistaken for outside changes.
+        bool isWritingBack {};
+
+        // Results of the last step, not yet written back. The step fills them in while the registry keeps the
+        // results of the step before, so a step on the physics thread never touches the registry.
+        std::vector<BodyState> bodyStates;
+        bool hasStepResults {};
+
+        // Entities whose bodies were awake after the step written back last, checked for having fallen asleep when
+        // the next one is written back.
+        std::vector<entt::entity> awakeBodies;
+
+        // Changes to rigidbodies and colliders while simulating, applied in a batch before the next step.
+        // Changed settings are applied to the existing bodies and fixtures, changed colliders replace the fixture.
+        bool isSimulating {};
+        std::vector<b2Body *> bodiesToDestroy;
+        std::unordered_set<entt::entity> bodiesToCreate;
+        std::unordered_set<entt::entity> bodiesToUpdate;
+        std::unordered_set<entt::entity> fixturesToRebuild;
+};
+
+// Physics queries, laid out to match their DelusionSharp counterparts so scripts can pass their arrays as they are.
+
+struct RaycastQuery {
+        glm::vec2 from;
+        glm::vec2 to;
+};
+
+// Box of the given size and rotation swept from its center along the translation.
+struct BoxCastQuery {
+        glm::vec2 center;
+        glm::vec2 size;
+        glm::vec2 translation;
+        float rotation;
+};
+
+// Closest hit of a cast, the fraction is how far along the ray or translation it is.
+struct QueryHit {
+        UniqueId id { 0 };
+        glm::vec2 point;
+        glm::vec2 normal;
+        float fraction {};
+        uint32_t isHit {};
+};
+
+// Sprite state of a scene, maintained through registry signals.
+struct SpriteTracking {
+        // World space bounds of every entity with both a world transform and a sprite.
+        SpatialHashGrid<entt::entity> index;
+
+        // Changes whenever a static sprite is added, changed or removed. Never shared between scenes.
+        uint64_t staticVersion {};
+};
 
 class Scene {
     private:
+        // Heap allocated, so the signal handlers' reference survives moving the scene.
+        // Declared before the registry, so they're still alive while destroying it notifies them.
+        std::unique_ptr<EntityIndex> m_index;
+        std::unique_ptr<TransformTracking> m_transforms;
+        std::unique_ptr<PhysicsTracking> m_physics;
+        std::unique_ptr<SpriteTracking> m_sprites;
+
         entt::registry m_registry;
 
-        std::vector<Entity> m_entities;
+        // Parent of the top level entities, not an entity of the scene itself.
+        entt::entity m_root { entt::null };
 
         std::unique_ptr<b2World> m_physicsWorld;
+
+        // Declared after the world, so a step still running finishes before the world is destroyed.
+        std::unique_ptr<ThreadPool> m_physicsThread;
+        std::future<void> m_physicsStep;
+
+        float m_interpolationAlpha = 1.0f;
     public:
-        Scene() = default;
+        Scene();
 
         Scene(const Scene &other) = delete;
 
@@ -24,43 +123,144 @@ class Scene {
 
         Scene &operator=(Scene &&other) noexcept;
 
+        // Clones the registry component type by component type, entities keep their identifiers and ids.
         [[nodiscard]] static Scene copy(Scene &source);
 
+        // Creates the physics world and a body for every rigidbody. Rigidbodies and colliders added, changed or
+        // removed afterwards are picked up by the next fixed update.
         void start();
 
         void stop();
 
-        void onUpdate(float deltaTime);
-
-        Entity &create();
+        // Steps the simulation by a fixed duration, see FixedTimestep.
+        // Only bodies moved from outside since the last step are pushed into Box2D before stepping, only awake
+        // non-static bodies are written back afterwards.
+        //
+        // With the physics thread enabled the step runs in the background, its results are written back by the next
+        // call (the registry lags one step behind the world). Moves made in between are applied before the next step.
+        void onFixedUpdate(float stepDuration);
 
-        void remove(Entity &entity);
+        // Steps the simulation on a dedicated thread, overlapping it with scripts, rendering and the editor.
+        void setPhysicsThreaded(bool isThreaded);
 
-        [[nodiscard]] std::vector<Entity> &entities() {
-            return m_entities;
+        [[nodiscard]] bool isPhysicsThreaded() const {
+            return m_physicsThread != nullptr;
         }
 
-        [[nodiscard]] const std::vector<Entity> &entities() const {
-            return m_entities;
+        // Recomputes the world transforms of changed entities and their descendants, top-down.
+        // Only the subtrees below changed entities are visited, nothing at all when nothing changed.
+        void updateWorldTransforms();
+
+        Entity create();
+
+        // Removes the entity along with all of its descendants, wherever it is in the hierarchy.
+        void remove(Entity entity);
+
+        // Top level entities, in creation order.
+        [[nodiscard]] Entity::Children entities() const {
+            return root().children();
         }
 
-        [[nodiscard]] std::optional<Entity *> getById(UniqueId id);
+        // Constant time, looked up in an index kept up to date as entities are created and removed.
+        [[nodiscard]] std::optional<Entity> getById(UniqueId id);
 
-        [[nodiscard]] std::optional<const Entity *> getById(UniqueId id) const;
+        [[nodiscard]] std::optional<const Entity> getById(UniqueId id) const;
 
+        // Visits every entity in no particular order.
         void forEachEntity(const std::function<void(Entity &)> &callback);
 
+        // Sprites are unit quads, scaled and rotated around the transform's position.
+        [[nodiscard]] static BoundingBox spriteBounds(const WorldTransformComponent &transform);
+
+        // Collects entities whose sprite intersects the given area.
+        // Only transform changes made through Entity::patchComponent (or registry patch/replace) are picked up, once
+        // world transforms have been updated.
+        void querySprites(const BoundingBox &bounds, std::vector<entt::entity> &result) const;
+
+        // Batched queries against the colliders of the running simulation, one call answers any number of queries.
+        // Results go into caller provided buffers and refer to entities by id. Nothing is found while the scene isn't
+        // simulating; with the physics thread enabled a running step is waited for first.
+        // Throws std::invalid_argument when there's less room for hits or result counts than there are queries.
+
+        // Collects the entities whose collider overlaps each box into the results, one query after the other, and
+        // stores how many were found for each query into the result counts. Results which don't fit are dropped.
+        // Returns the total number of results written.
+        size_t queryOverlaps(
+            std::span<const BoundingBox> queries, std::span<UniqueId> results, std::span<uint32_t> resultCounts
+        );
+
+        // Stores the closest hit along each ray into the hits.
+        void raycast(std::span<const RaycastQuery> queries, std::span<QueryHit> hits);
+
+        // Stores the first collider each box runs into in the hits. Boxes overlapping a collider from the start hit it
+        // at fraction 0, at the box's center and without a normal.
+        void boxCast(std::span<const BoxCastQuery> queries, std::span<QueryHit> hits);
+
+        // Entities with both a world transform and a sprite. The group owns both pools, it keeps their components
+        // packed at the front of the pools in the same order, so iterating it is a linear pass over both arrays.
+        [[nodiscard]] auto sprites() {
+            return m_registry.group<WorldTransformComponent, SpriteComponent>();
+        }
+
+        // Entities with a rigidbody and a world transform, owning only the rigidbody pool (world transforms are owned
+        // by the sprite group already).
+        [[nodiscard]] auto rigidbodies() {
+            return m_registry.group<RigidbodyComponent>(entt::get<WorldTransformComponent>);
+        }
+
+        [[nodiscard]] size_t spriteCount() const {
+            return m_sprites->index.size();
+        }
+
+        // Renderers compare it to the version they last recorded static sprites with to know when to record again.
+        // Sprite changes are only picked up through Entity::patchComponent (or registry patch/replace).
+        [[nodiscard]] uint64_t staticSpritesVersion() const {
+            return m_sprites->staticVersion;
+        }
+
+        [[nodiscard]] entt::registry &registry() {
+            return m_registry;
+        }
+
+        [[nodiscard]] const entt::registry &registry() const {
+            return m_registry;
+        }
+
+        // How far the current frame is between the previous and the last fixed step, moving rigidbodies are drawn
+        // interpolated accordingly.
+        [[nodiscard]] float interpolationAlpha() const {
+            return m_interpolationAlpha;
+        }
+
+        void setInterpolationAlpha(float interpolationAlpha) {
+            m_interpolationAlpha = interpolationAlpha;
+        }
+
         [[nodiscard]] b2World *physicsWorld() const {
             return m_physicsWorld.get();
         }
     private:
-        [[nodiscard]] std::optional<Entity *> getById(Entity &parent, UniqueId id);
+        // Handles don't carry constness, const methods only hand it out for reading.
+        [[nodiscard]] Entity root() const {
+            return { const_cast<entt::registry *>(&m_registry), m_root };
+        }
+
+        // World transform of the closest ancestor with a transform, identity if there's none.
+        [[nodiscard]] WorldTransformComponent parentWorldTransform(entt::entity entity) const;
+
+        // Blocks until the step running on the physics thread, if any, has finished.
+        void waitForPhysicsStep();
 
-        [[nodiscard]] std::optional<const Entity *> getById(const Entity &parent, UniqueId id) const;
+        void writeBackBodyStates();
 
-        void forEachChild(Entity &parent, const std::function<void(Entity &)> &callback);
+        // Destroys, creates and updates the bodies queued since the last step.
+        void updateBodies();
 
-        static void copyEntity(Entity &target, Entity &source);
+        void createBody(entt::entity entity, RigidbodyComponent &rigidbody, const WorldTransformComponent &transform);
 
-        void updateRegistry(Entity &entity, entt::registry *registry);
+        // Returns null for entities without a collider, their bodies have no fixture.
+        b2Fixture *createFixture(
+            entt::entity entity, b2Body *body, const RigidbodyComponent &rigidbody,
+            const WorldTransformComponent &transform
+        );
 };
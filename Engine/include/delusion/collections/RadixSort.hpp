@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Stable LSD radix sort by a 64-bit key, one byte per pass.
+// Passes over bytes which are the same for every element are skipped, so keys with mostly constant fields sort in a
+// couple of passes. The scratch buffer is only used as storage and can be reused between calls to avoid allocations.
+template <typename T, typename KeyFunction>
+void radixSort(std::vector<T> &elements, std::vector<T> &scratch, KeyFunction key) {
+    constexpr size_t byteCount = sizeof(uint64_t);
+
+    if (elements.size() < 2)
+        return;
+
+    std::array<std::array<size_t, 256>, byteCount> histograms {};
+
+    for (const auto &element : elements) {
+        uint64_t elementKey = key(element);
+
+        for (size_t byte = 0; byte < byteCount; byte++) {
+            histograms[byte][(elementKey >> (byte * 8)) & 0xFF] += 1;
+        }
+    }
+
+    scratch.resize(elements.size());
+
+    for (size_t byte = 0; byte < byteCount; byte++) {
+        auto &histogram = histograms[byte];
+
+        uint64_t firstElementByte = (key(elements.front()) >> (byte * 8)) & 0xFF;
+
+        if (histogram[firstElementByte] == elements.size())
+            continue;
+
+        size_t offset = 0;
+
+        for (auto &count : histogram) {
+            auto bucketSize = count;
+
+            count = offset;
+            offset += bucketSize;
+        }
+
+        for (const auto &element : elements) {
+            scratch[histogram[(key(element) >> (byte * 8)) & 0xFF]++] = element;
+        }
+
+        elements.swap(scratch);
+    }
+}
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "delusion/BoundingBox.hpp"
+
+// Uniform grid over an unbounded world, cells are created on demand and looked up by their coordinates.
+//
+// Every element is stored in each cell its bounding box overlaps, so moving an element only touches the cells it
+// enters or leaves. Elements spanning too many cells are kept in a separate list which is tested by every query.
+template <typename Key, typename Hash = std::hash<Key>>
+class SpatialHashGrid {
+    private:
+        static constexpr int64_t s_maxCellsPerElement = 64;
+
+        struct CellRange {
+                int32_t minX;
+                int32_t minY;
+                int32_t maxX;
+                int32_t maxY;
+
+                [[nodiscard]] bool operator==(const CellRange &other) const = default;
+
+                [[nodiscard]] int64_t cellCount() const {
+                    return (static_cast<int64_t>(maxX) - minX + 1) * (static_cast<int64_t>(maxY) - minY + 1);
+                }
+        };
+
+        struct Element {
+                Key key;
+                BoundingBox bounds;
+                CellRange cells;
+
+                bool isOversized;
+
+                // Last query which visited the element, so elements overlapping several cells are reported once.
+                mutable uint64_t queryStamp;
+        };
+
+        float m_cellSize;
+
+        // Elements are referenced by pointer from the cells, unordered_map keeps them at a stable address.
+        std::unordered_map<Key, Element, Hash> m_elements;
+        std::unordered_map<uint64_t, std::vector<const Element *>> m_cells;
+        std::vector<const Element *> m_oversizedElements;
+
+        mutable uint64_t m_queryStamp {};
+    public:
+        explicit SpatialHashGrid(float cellSize = 4.0f) : m_cellSize(cellSize) {}
+
+        SpatialHashGrid(const SpatialHashGrid &) = delete;
+
+        SpatialHashGrid(SpatialHashGrid &&) noexcept = delete;
+
+        SpatialHashGrid &operator=(const SpatialHashGrid &) = delete;
+
+        SpatialHashGrid &operator=(SpatialHashGrid &&) noexcept = delete;
+
+        // Inserts the element or moves it if it's already present.
+        void insert(const Key &key, const BoundingBox &bounds) {
+            auto cells = cellRange(bounds);
+            bool isOversized = cells.cellCount() > s_maxCellsPerElement;
+
+            auto result = m_elements.find(key);
+
+            if (result != m_elements.end()) {
+                auto &element = result->second;
+
+                if (element.isOversized == isOversized && (isOversized || element.cells == cells)) {
+                    element.bounds = bounds;
+
+                    return;
+                }
+
+                unlink(element);
+
+                element.bounds = bounds;
+                element.cells = cells;
+                element.isOversized = isOversized;
+
+                link(element);
+
+                return;
+            }
+
+            auto [iterator, inserted] = m_elements.emplace(
+                key,
+                Element {
+                    .key = key,
+                    .bounds = bounds,
+                    .cells = cells,
+                    .isOversized = isOversized,
+                    .queryStamp = 0,
+                }
+            );
+
+            link(iterator->second);
+        }
+
+        void remove(const Key &key) {
+            auto result = m_elements.find(key);
+
+            if (result == m_elements.end())
+                return;
+
+            unlink(result->second);
+
+            m_elements.erase(result);
+        }
+
+        // Calls the callback with the key of every element whose bounding box intersects the given one.
+        template <typename Callback>
+        void query(const BoundingBox &bounds, Callback &&callback) const {
+            auto cells = cellRange(bounds);
+
+            // Looking up more cells than there are elements would be slower than testing every element
+            if (cells.cellCount() > static_cast<int64_t>(m_elements.size())) {
+                for (const auto &[key, element] : m_elements) {
+                    if (element.bounds.intersects(bounds)) {
+                        callback(key);
+                    }
+                }
+
+                return;
+            }
+
+            m_queryStamp += 1;
+
+            for (int32_t y = cells.minY; y <= cells.maxY; y++) {
+                for (int32_t x = cells.minX; x <= cells.maxX; x++) {
+                    auto cell = m_cells.find(cellKey(x, y));
+
+                    if (cell == m_cells.end())
+                        continue;
+
+                    for (const auto *element : cell->second) {
+                        if (element->queryStamp != m_queryStamp && element->bounds.intersects(bounds)) {
+                            element->queryStamp = m_queryStamp;
+
+                            callback(element->key);
+                        }
+                    }
+                }
+            }
+
+            for (const auto *element : m_oversizedElements) {
+                if (element->bounds.intersects(bounds)) {
+                    callback(element->key);
+                }
+            }
+        }
+
+        void clear() {
+            m_elements.clear();
+            m_cells.clear();
+            m_oversizedElements.clear();
+        }
+
+        [[nodiscard]] size_t size() const {
+            return m_elements.size();
+        }
+    private:
+        [[nodiscard]] CellRange cellRange(const BoundingBox &bounds) const {
+            return CellRange {
+                .minX = static_cast<int32_t>(std::floor(bounds.min.x / m_cellSize)),
+                .minY = static_cast<int32_t>(std::floor(bounds.min.y / m_cellSize)),
+                .maxX = static_cast<int32_t>(std::floor(bounds.max.x / m_cellSize)),
+                .maxY = static_cast<int32_t>(std::floor(bounds.max.y / m_cellSize)),
+            };
+        }
+
+        [[nodiscard]] static uint64_t cellKey(int32_t x, int32_t y) {
+            return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+        }
+
+        void link(const Element &element) {
+            if (element.isOversized) {
+                m_oversizedElements.push_back(&element);
+
+                return;
+            }
+
+            for (int32_t y = element.cells.minY; y <= element.cells.maxY; y++) {
+                for (int32_t x = element.cells.minX; x <= element.cells.maxX; x++) {
+                    m_cells[cellKey(x, y)].push_back(&element);
+                }
+            }
+        }
+
+        void unlink(const Element &element) {
+            if (element.isOversized) {
+                eraseFrom(m_oversizedElements, &element);
+
+                return;
+            }
+
+            for (int32_t y = element.cells.minY; y <= element.cells.maxY; y++) {
+                for (int32_t x = element.cells.minX; x <= element.cells.maxX; x++) {
+                    auto cell = m_cells.find(cellKey(x, y));
+
+                    eraseFrom(cell->second, &element);
+
+                    if (cell->second.empty()) {
+                        m_cells.erase(cell);
+                    }
+                }
+            }
+        }
+
+        static void eraseFrom(std::vector<const Element *> &elements, const Element *element) {
+            auto result = std::find(elements.begin(), elements.end(), element);
+
+            *result = elements.back();
+            elements.pop_back();
+        }
+};
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <string>
+
+#include "delusion/Image.hpp"
+
+class ImageEncoder {
+    public:
+        // Format is picked based on the extension, only png is supported for now.
+        static bool encode(const std::string &path, Image &image);
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <memory>
+
+#include <webgpu.h>
+#include <wgpu.h>
+
+struct FramePacingStatistics {
+        // Time the CPU spent waiting for a frame slot at the beginning of the latest frame.
+        float cpuWaitMilliseconds {};
+
+        // Time from submitting the latest completed frame until the GPU was seen finishing it.
+        float gpuLatencyMilliseconds {};
+
+        uint32_t framesInFlight {};
+};
+
+// Limits how many frames the CPU can get ahead of the GPU.
+//
+// Submitted frames are tracked with wgpuQueueOnSubmittedWorkDone. While the limit is reached beginFrame() waits for the
+// submission of the oldest frame only, later frames keep the GPU busy in the meantime.
+// A lower limit means lower input latency, a higher one keeps the GPU busy when frame times vary.
+//
+// Usage: beginFrame() -> (record, wgpuQueueSubmitForIndex) -> endFrame(index) -> beginFrame() -> ...
+class FramePacer {
+    public:
+        static constexpr uint32_t s_maxFramesInFlight = 4;
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct Frame {
+                FramePacer *pacer {};
+
+                Clock::time_point submitTime;
+                WGPUSubmissionIndex submissionIndex {};
+
+                bool isInFlight = false;
+        };
+
+        WGPUDevice m_device;
+        WGPUQueue m_queue;
+
+        std::array<Frame, s_maxFramesInFlight> m_frames;
+
+        uint32_t m_maxFramesInFlight;
+        uint32_t m_framesInFlight {};
+
+        FramePacingStatistics m_statistics {};
+
+        FramePacer(WGPUDevice device, WGPUQueue queue, uint32_t maxFramesInFlight);
+    public:
+        FramePacer(const FramePacer &other) = delete;
+        FramePacer(FramePacer &&other) noexcept = delete;
+
+        // Waits for every frame in flight.
+        ~FramePacer();
+
+        FramePacer &operator=(const FramePacer &other) = delete;
+        FramePacer &operator=(FramePacer &&other) noexcept = delete;
+
+        [[nodiscard]] static std::unique_ptr<FramePacer> create(
+            WGPUDevice device, WGPUQueue queue, uint32_t maxFramesInFlight = 2
+        );
+
+        void beginFrame();
+
+        // Marks everything submitted since beginFrame() as one frame, ending with the given submission.
+        void endFrame(WGPUSubmissionIndex submissionIndex);
+
+        // Clamped to [1, s_maxFramesInFlight].
+        void setMaxFramesInFlight(uint32_t maxFramesInFlight);
+
+        [[nodiscard]] uint32_t maxFramesInFlight() const {
+            return m_maxFramesInFlight;
+        }
+
+        [[nodiscard]] const FramePacingStatistics &statistics() const {
+            return m_statistics;
+        }
+};
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <webgpu.h>
+
+struct GpuPassTiming {
+        std::string name;
+        double milliseconds;
+};
+
+// Measures how long render passes take on the GPU with timestamp queries, requires the TimestampQuery feature.
+//
+// Every frame in flight owns a query set and a readback buffer. Timestamps are resolved at the end of the frame and
+// mapped asynchronously, so timings lag a few frames behind. A frame whose slot is still being read back isn't
+// profiled at all, the profiler never waits for the GPU.
+//
+// Usage: beginFrame() -> timestampWrites() for every pass ... -> resolve() -> (submit) -> endFrame() -> beginFrame()
+class GpuProfiler {
+    private:
+        struct Frame {
+                GpuProfiler *profiler;
+
+                WGPUQuerySet querySet;
+                WGPUBuffer resolveBuffer;
+                WGPUBuffer readbackBuffer;
+
+                std::vector<std::string> passNames;
+
+                bool isReadingBack = false;
+        };
+
+        WGPUDevice m_device;
+
+        uint32_t m_maxPassCount;
+
+        std::vector<std::unique_ptr<Frame>> m_frames;
+        size_t m_currentFrameIndex = 0;
+
+        bool m_hasFrameBegun = false;
+        bool m_isRecording = false;
+        bool m_isEnabled = false;
+
+        std::vector<GpuPassTiming> m_timings;
+
+        GpuProfiler(WGPUDevice device, uint32_t maxPassCount, size_t framesInFlight);
+    public:
+        GpuProfiler(const GpuProfiler &other) = delete;
+        GpuProfiler(GpuProfiler &&other) noexcept = delete;
+
+        ~GpuProfiler();
+
+        GpuProfiler &operator=(const GpuProfiler &other) = delete;
+        GpuProfiler &operator=(GpuProfiler &&other) noexcept = delete;
+
+        [[nodiscard]] static std::unique_ptr<GpuProfiler> create(
+            WGPUDevice device, uint32_t maxPassCount = 16, size_t framesInFlight = 3
+        );
+
+        void beginFrame();
+
+        // Timestamp writes for the next pass of the frame, nothing if profiling is disabled, the frame is skipped or
+        // every query of the frame is used up.
+        [[nodiscard]] std::optional<WGPURenderPassTimestampWrites> timestampWrites(const std::string &passName);
+
+        // Records the resolve and the copy into the readback buffer, after every profiled pass.
+        void resolve(WGPUCommandEncoder commandEncoder);
+
+        // Starts reading back the frame's timestamps, after the frame has been submitted.
+        void endFrame();
+
+        void setEnabled(bool isEnabled);
+
+        [[nodiscard]] bool isEnabled() const {
+            return m_isEnabled;
+        }
+
+        // Timings of the latest frame read back, in the order the passes were recorded.
+        [[nodiscard]] const std::vector<GpuPassTiming> &timings() const {
+            return m_timings;
+        }
+};
@@ -2,10 +2,12 @@
 
 #include <cassert>
 #include <iostream>
+#include <memory>
 
 #include <glfw3webgpu.h>
 #include <webgpu.h>
 
+#include "delusion/graphics/FramePacer.hpp"
 #include "delusion/Window.hpp"
 
 class GraphicsBackend {
@@ -20,6 +22,15 @@ class GraphicsBackend {
         WGPUSurfaceCapabilities m_surfaceCapabilities = {};
 
         WGPUTextureFormat m_preferredFormat {};
+
+        bool m_hasTimestampQueries = false;
+
+        WGPUPresentMode m_presentMode = WGPUPresentMode_Fifo;
+
+        uint32_t m_surfaceWidth {};
+        uint32_t m_surfaceHeight {};
+
+        std::unique_ptr<FramePacer> m_framePacer;
     public:
         GraphicsBackend();
 
@@ -27,8 +38,25 @@ class GraphicsBackend {
 
         void setup(const Window *window);
 
+        // Sets up a device without any window or surface, for rendering offscreen only (benchmarks, CI...).
+        // A software adapter is preferred by default, so results don't depend on the machine's GPU.
+        void setupHeadless(bool preferFallbackAdapter = true);
+
         void configureSurface(uint32_t width, uint32_t height);
 
+        // Fifo is always supported and is used for unsupported modes. Reconfigures the surface if it's configured.
+        void setPresentMode(WGPUPresentMode presentMode);
+
+        [[nodiscard]] bool isPresentModeSupported(WGPUPresentMode presentMode) const;
+
+        [[nodiscard]] WGPUPresentMode presentMode() const {
+            return m_presentMode;
+        }
+
+        [[nodiscard]] FramePacer &framePacer() {
+            return *m_framePacer;
+        }
+
         [[nodiscard]] WGPUDevice device() const {
             return m_device;
         }
@@ -37,10 +65,15 @@ class GraphicsBackend {
             return m_queue;
         }
 
+        // Null for headless backends.
         [[nodiscard]] WGPUSurface surface() const {
             return m_surface;
         }
 
+        [[nodiscard]] bool isHeadless() const {
+            return m_surface == nullptr;
+        }
+
         [[nodiscard]] const WGPUSurfaceCapabilities &surfaceCapabilities() const {
             return m_surfaceCapabilities;
         }
@@ -48,7 +81,14 @@ class GraphicsBackend {
         [[nodiscard]] WGPUTextureFormat preferredFormat() const {
             return m_preferredFormat;
         }
+
+        // Whether the device has been created with the TimestampQuery feature, which GPU profiling needs.
+        [[nodiscard]] bool hasTimestampQueries() const {
+            return m_hasTimestampQueries;
+        }
     private:
+        void createDevice();
+
         [[nodiscard]] WGPUAdapter requestAdapter(WGPUInstance instance, WGPURequestAdapterOptions const *options);
 
         [[nodiscard]] WGPUDevice requestDevice(WGPUAdapter adapter, WGPUDeviceDescriptor const *descriptor);
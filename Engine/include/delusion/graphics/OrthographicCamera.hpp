@@ -3,6 +3,8 @@
 #include <glm/ext.hpp>
 #include <glm/glm.hpp>
 
+#include "delusion/BoundingBox.hpp"
+
 class OrthographicCamera {
     private:
         glm::vec3 m_position = glm::vec3(0.0f, 0.0f, 0.0f);
@@ -53,4 +55,11 @@ class OrthographicCamera {
         [[nodiscard]] glm::mat4 viewProjectionMatrix() const {
             return projectionMatrix() * viewMatrix();
         }
+
+        // Visible area in world space.
+        [[nodiscard]] BoundingBox bounds() const {
+            glm::vec2 halfExtents(m_aspectRatio * m_zoom, m_zoom);
+
+            return { glm::vec2(m_position) - halfExtents, glm::vec2(m_position) + halfExtents };
+        }
 };
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <webgpu.h>
+
+enum class BlendMode : int {
+    Alpha = 0,
+    Opaque = 1
+};
+
+struct RenderState {
+        WGPUTextureFormat colorFormat = WGPUTextureFormat_RGBA8Unorm;
+        BlendMode blendMode = BlendMode::Alpha;
+
+        [[nodiscard]] bool operator==(const RenderState &other) const = default;
+};
+
+namespace std {
+    template <>
+    class hash<RenderState> {
+        public:
+            std::size_t operator()(const RenderState &renderState) const {
+                return hash<uint64_t>()(
+                    (static_cast<uint64_t>(renderState.colorFormat) << 8) |
+                    static_cast<uint64_t>(renderState.blendMode)
+                );
+            }
+    };
+}
+
+// Owns every long-lived GPU object the renderer needs: bind group layouts, the pipeline layout, the sampler,
+// render pipelines (keyed by render state) and per-texture bind groups (keyed by 2D array texture view).
+// Bind groups are evicted as soon as the texture they reference is destroyed.
+class RenderCache {
+    private:
+        WGPUDevice m_device;
+        WGPUShaderModule m_shaderModule;
+
+        std::vector<WGPUVertexBufferLayout> m_vertexBufferLayouts;
+
+        WGPUBindGroupLayout m_cameraBindGroupLayout;
+        WGPUBindGroupLayout m_textureBindGroupLayout;
+        WGPUPipelineLayout m_pipelineLayout;
+
+        WGPUSampler m_sampler;
+
+        std::unordered_map<RenderState, WGPURenderPipeline> m_pipelines;
+        std::unordered_map<WGPUTextureView, WGPUBindGroup> m_textureBindGroups;
+
+        size_t m_destroyListenerHandle {};
+
+        uint64_t m_createdObjectCount {};
+
+        RenderCache(
+            WGPUDevice device, WGPUShaderModule shaderModule, std::vector<WGPUVertexBufferLayout> vertexBufferLayouts,
+            WGPUBindGroupLayout cameraBindGroupLayout, WGPUBindGroupLayout textureBindGroupLayout,
+            WGPUPipelineLayout pipelineLayout, WGPUSampler sampler
+        )
+            : m_device(device), m_shaderModule(shaderModule), m_vertexBufferLayouts(std::move(vertexBufferLayouts)),
+              m_cameraBindGroupLayout(cameraBindGroupLayout), m_textureBindGroupLayout(textureBindGroupLayout),
+              m_pipelineLayout(pipelineLayout), m_sampler(sampler) {}
+    public:
+        RenderCache(const RenderCache &other) = delete;
+        RenderCache(RenderCache &&other) noexcept = delete;
+
+        ~RenderCache();
+
+        RenderCache &operator=(const RenderCache &other) = delete;
+        RenderCache &operator=(RenderCache &&other) noexcept = delete;
+
+        // Vertex buffer layouts must point to attribute arrays that outlive the cache.
+        // The camera uniform is bound with a dynamic offset.
+        [[nodiscard]] static std::unique_ptr<RenderCache> create(
+            WGPUDevice device, WGPUShaderModule shaderModule, std::vector<WGPUVertexBufferLayout> vertexBufferLayouts,
+            uint64_t cameraUniformSize
+        );
+
+        [[nodiscard]] WGPURenderPipeline pipeline(const RenderState &renderState);
+
+        [[nodiscard]] WGPUBindGroup textureBindGroup(WGPUTextureView textureView);
+
+        void evict(WGPUTextureView textureView);
+
+        [[nodiscard]] WGPUBindGroupLayout cameraBindGroupLayout() const {
+            return m_cameraBindGroupLayout;
+        }
+
+        [[nodiscard]] WGPUSampler sampler() const {
+            return m_sampler;
+        }
+
+        // Total number of GPU objects created by the cache since it was built, useful to verify that steady-state
+        // frames don't create anything.
+        [[nodiscard]] uint64_t createdObjectCount() const {
+            return m_createdObjectCount;
+        }
+};
@@ -1,11 +1,42 @@
 #pragma once
 
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #include <webgpu.h>
 
 #include "delusion/Components.hpp"
+#include "delusion/graphics/GpuProfiler.hpp"
 #include "delusion/graphics/OrthographicCamera.hpp"
+#include "delusion/graphics/RenderCache.hpp"
 #include "delusion/graphics/Shader.hpp"
+#include "delusion/graphics/TexturePool.hpp"
+#include "delusion/graphics/UploadRing.hpp"
 #include "delusion/Scene.hpp"
+#include "delusion/threading/ThreadPool.hpp"
+
+struct RendererStatistics {
+        uint32_t renderPasses {};
+        uint32_t drawCalls {};
+        uint32_t renderBundles {};
+        uint32_t sprites {};
+        uint32_t staticSprites {};
+        uint32_t culledSprites {};
+        uint32_t createdGpuObjects {};
+};
+
+// Recording of the static sprites of a bucket sharing a sorting layer and order in layer.
+struct StaticSpriteBundle {
+        uint32_t drawOrder;
+
+        // Of every sprite in the bucket, the bundle is only executed while it intersects the camera's view.
+        BoundingBox bounds;
+
+        WGPURenderBundle renderBundle;
+        uint32_t spriteCount;
+        uint32_t drawCallCount;
+};
 
 class Renderer {
     private:
@@ -14,29 +45,84 @@ class Renderer {
         WGPUSurfaceCapabilities surfaceCapabilities;
 
         std::unique_ptr<Shader> shader;
+        std::unique_ptr<RenderCache> renderCache;
+        std::unique_ptr<TexturePool> texturePool;
+
+        // Encodes render bundles for large sprite counts.
+        std::unique_ptr<ThreadPool> threadPool;
+
+        std::unique_ptr<UploadRing> uniformRing;
+        std::unique_ptr<UploadRing> instanceRing;
+
+        uint64_t uniformAlignment;
+
+        // One bind group per uniform ring buffer, the camera uniform itself is selected with a dynamic offset.
+        std::unordered_map<WGPUBuffer, WGPUBindGroup> cameraBindGroups;
 
-        WGPUBuffer quadVertexBuffer;
+        // Static sprites are recorded into render bundles drawing from their own instance buffer, kept until the
+        // scene's static sprites change. Sprites are bucketed by grid cell, every bucket gets one bundle per draw
+        // order in use. Bundles are kept in draw order, so they can be interleaved with dynamic sprites.
+        uint64_t staticSpritesVersion {};
+        WGPUBuffer staticInstanceBuffer {};
+        uint64_t staticInstanceBufferSize {};
+        WGPUBuffer staticUniformBuffer {};
+        std::vector<StaticSpriteBundle> staticRenderBundles;
+        uint32_t staticSpriteCount {};
+
+        // Never drawn, so never culled either.
+        uint32_t texturelessStaticSpriteCount {};
+
+        RendererStatistics lastFrameStatistics {};
+
+        // Not owned, the profiled frame also spans passes outside of the renderer.
+        GpuProfiler *gpuProfiler {};
 
         Renderer(
             WGPUDevice device, WGPUQueue queue, WGPUSurfaceCapabilities surfaceCapabilities,
-            std::unique_ptr<Shader> shader, WGPUBuffer quadVertexBuffer
+            std::unique_ptr<Shader> shader, std::unique_ptr<RenderCache> renderCache,
+            std::unique_ptr<TexturePool> texturePool, std::unique_ptr<ThreadPool> threadPool,
+            std::unique_ptr<UploadRing> uniformRing, std::unique_ptr<UploadRing> instanceRing,
+            uint64_t uniformAlignment
         )
             : device(device), queue(queue), surfaceCapabilities(surfaceCapabilities), shader(std::move(shader)),
-              quadVertexBuffer(quadVertexBuffer) {}
+              renderCache(std::move(renderCache)), texturePool(std::move(texturePool)),
+              threadPool(std::move(threadPool)), uniformRing(std::move(uniformRing)),
+              instanceRing(std::move(instanceRing)), uniformAlignment(uniformAlignment) {}
+
+        void recordStaticSprites(WGPUCommandEncoder commandEncoder, Scene &scene, const RenderState &renderState);
+
+        [[nodiscard]] WGPUBindGroup cameraBindGroup(WGPUBuffer uniformBuffer);
     public:
         Renderer(const Renderer &other) = delete;
 
         Renderer(Renderer &&other) noexcept = delete;
 
+        ~Renderer();
+
         Renderer &operator=(const Renderer &other) = delete;
 
         Renderer &operator=(Renderer &&other) noexcept = delete;
 
+        // Relative shader paths are resolved against the working directory.
         [[nodiscard]] static Renderer create(
-            WGPUDevice device, WGPUQueue queue, WGPUSurfaceCapabilities surfaceCapabilities
+            WGPUDevice device, WGPUQueue queue, WGPUSurfaceCapabilities surfaceCapabilities,
+            const std::string &shaderPath = "src/shader.wgsl"
         );
 
         void renderScene(
             WGPUCommandEncoder commandEncoder, WGPUTextureView renderTarget, OrthographicCamera &camera, Scene &scene
         );
+
+        [[nodiscard]] const RendererStatistics &statistics() const {
+            return lastFrameStatistics;
+        }
+
+        // Scene passes are profiled with the given profiler from now on, nullptr stops profiling them.
+        void setGpuProfiler(GpuProfiler *profiler) {
+            gpuProfiler = profiler;
+        }
+
+        [[nodiscard]] GpuProfiler *profiler() const {
+            return gpuProfiler;
+        }
 };
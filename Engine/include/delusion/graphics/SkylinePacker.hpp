@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+struct PackedPosition {
+        uint32_t x;
+        uint32_t y;
+};
+
+// Online rectangle packer using the bottom-left skyline heuristic.
+// Rectangles can't be freed individually, the whole area is reclaimed with reset().
+class SkylinePacker {
+    private:
+        struct Segment {
+                uint32_t x;
+                uint32_t y;
+                uint32_t width;
+        };
+
+        uint32_t m_width;
+        uint32_t m_height;
+
+        std::vector<Segment> m_skyline;
+    public:
+        SkylinePacker(uint32_t width, uint32_t height);
+
+        [[nodiscard]] std::optional<PackedPosition> pack(uint32_t width, uint32_t height);
+
+        void reset();
+
+        [[nodiscard]] uint32_t width() const {
+            return m_width;
+        }
+
+        [[nodiscard]] uint32_t height() const {
+            return m_height;
+        }
+    private:
+        [[nodiscard]] std::optional<uint32_t> fit(size_t segmentIndex, uint32_t width, uint32_t height) const;
+};
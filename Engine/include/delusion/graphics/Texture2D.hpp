@@ -1,24 +1,45 @@
 #pragma once
 
+#include <cstdint>
+#include <functional>
+#include <limits>
 #include <memory>
 
+#include <glm/vec4.hpp>
 #include <webgpu.h>
 
 #include "delusion/Image.hpp"
 #include "delusion/UniqueId.hpp"
 
 class Texture2D {
+    public:
+        using DestroyListener = std::function<void(Texture2D &)>;
     private:
         UniqueId m_id;
 
         WGPUTexture m_texture;
         WGPUTextureView m_textureView;
+        WGPUTextureView m_arrayTextureView;
 
         uint32_t m_width;
         uint32_t m_height;
+        uint32_t m_mipLevelCount;
+
+        // Set only for regions, which don't own any GPU objects and sample a part of their page instead.
+        std::shared_ptr<Texture2D> m_page;
+        glm::vec4 m_uvRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+
+        Texture2D(
+            UniqueId id, WGPUTexture texture, WGPUTextureView textureView, WGPUTextureView arrayTextureView,
+            uint32_t width, uint32_t height, uint32_t mipLevelCount
+        )
+            : m_id(id), m_texture(texture), m_textureView(textureView), m_arrayTextureView(arrayTextureView),
+              m_width(width), m_height(height), m_mipLevelCount(mipLevelCount) {}
 
-        Texture2D(UniqueId id, WGPUTexture texture, WGPUTextureView textureView, uint32_t width, uint32_t height)
-            : m_id(id), m_texture(texture), m_textureView(textureView), m_width(width), m_height(height) {}
+        Texture2D(UniqueId id, std::shared_ptr<Texture2D> page, glm::vec4 uvRect, uint32_t width, uint32_t height)
+            : m_id(id), m_texture(page->m_texture), m_textureView(page->m_textureView),
+              m_arrayTextureView(page->m_arrayTextureView), m_width(width), m_height(height),
+              m_mipLevelCount(page->m_mipLevelCount), m_page(std::move(page)), m_uvRect(uvRect) {}
     public:
         Texture2D(const Texture2D &other) = delete;
         Texture2D(Texture2D &&other) noexcept = delete;
@@ -28,22 +49,44 @@ class Texture2D {
         Texture2D &operator=(const Texture2D &other) = delete;
         Texture2D &operator=(Texture2D &&other) noexcept = delete;
 
+        // Uploads the image along with its mip chain, generated on the CPU and limited to the given number of levels.
         [[nodiscard]] static std::unique_ptr<Texture2D> create(
-            UniqueId id, WGPUDevice device, WGPUQueue queue, Image &image
+            UniqueId id, WGPUDevice device, WGPUQueue queue, Image &image,
+            uint32_t maxMipLevelCount = std::numeric_limits<uint32_t>::max()
         );
 
         [[nodiscard]] static std::unique_ptr<Texture2D> create(
             UniqueId id, WGPUDevice device, uint32_t width, uint32_t height, bool isRenderAttachment
         );
 
+        // Region of an atlas page, uvRect is (offset, size) in the page's UV space.
+        [[nodiscard]] static std::unique_ptr<Texture2D> createRegion(
+            UniqueId id, std::shared_ptr<Texture2D> page, glm::vec4 uvRect
+        );
+
+        // Listeners are notified right before a texture's views are released, so that anything keyed by them
+        // (e.g. cached bind groups) can be evicted before the addresses get reused.
+        static size_t addDestroyListener(DestroyListener listener);
+
+        static void removeDestroyListener(size_t handle);
+
         [[nodiscard]] UniqueId id() {
             return m_id;
         }
 
+        [[nodiscard]] WGPUTexture texture() {
+            return m_texture;
+        }
+
         [[nodiscard]] WGPUTextureView view() {
             return m_textureView;
         }
 
+        // Single layer 2D array view of the texture, for shaders sampling from texture arrays.
+        [[nodiscard]] WGPUTextureView arrayView() {
+            return m_arrayTextureView;
+        }
+
         [[nodiscard]] uint32_t width() const {
             return m_width;
         }
@@ -51,4 +94,21 @@ class Texture2D {
         [[nodiscard]] uint32_t height() const {
             return m_height;
         }
+
+        // Both views cover every mip level.
+        [[nodiscard]] uint32_t mipLevelCount() const {
+            return m_mipLevelCount;
+        }
+
+        [[nodiscard]] bool isRegion() const {
+            return m_page != nullptr;
+        }
+
+        [[nodiscard]] const std::shared_ptr<Texture2D> &page() const {
+            return m_page;
+        }
+
+        [[nodiscard]] glm::vec4 uvRect() const {
+            return m_uvRect;
+        }
 };
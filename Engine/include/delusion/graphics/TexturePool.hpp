@@ -0,0 +1,80 @@
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <webgpu.h>
+
+#include "delusion/graphics/SkylinePacker.hpp"
+#include "delusion/graphics/Texture2D.hpp"
+
+// Where a texture can be sampled from: a 2D array view, the layer inside it and the UV rect (offset, size) covering
+// the texture within that layer.
+struct TextureRegion {
+        WGPUTextureView view;
+
+        uint32_t layer;
+        glm::vec4 uvRect;
+};
+
+// Packs small sprite textures into the layers of a single 2D array texture, so sprites using different textures can
+// still be drawn with one bind group (and one draw call).
+//
+// Textures are copied in lazily along with their first few mip levels, the first time a region is requested for them.
+// Their edge texels are extruded into a border around them, so filtering never picks up neighbouring textures.
+// Textures that are too large, are render attachments, lack a mip chain or don't fit anymore are sampled directly
+// through their own array view.
+// Space isn't reclaimed per texture, a layer is reset once every texture packed into it has been destroyed.
+class TexturePool {
+    private:
+        struct Layer {
+                SkylinePacker packer;
+
+                uint32_t textureCount {};
+        };
+
+        struct Entry {
+                uint32_t layer;
+                glm::vec4 uvRect;
+        };
+
+        WGPUTexture m_texture;
+        WGPUTextureView m_textureView;
+
+        // Two rows wide enough for the padded edges of any pooled texture, staging copies of a texture's top and
+        // bottom rows while they're extruded (copies within a single mip level of a layer aren't allowed).
+        WGPUTexture m_edgeTexture;
+
+        uint32_t m_pageSize;
+        uint32_t m_maxTextureSize;
+
+        std::vector<Layer> m_layers;
+        std::unordered_map<Texture2D *, Entry> m_entries;
+
+        size_t m_destroyListenerHandle {};
+
+        TexturePool(
+            WGPUTexture texture, WGPUTextureView textureView, WGPUTexture edgeTexture, uint32_t pageSize,
+            uint32_t layerCount, uint32_t maxTextureSize
+        );
+    public:
+        TexturePool(const TexturePool &other) = delete;
+        TexturePool(TexturePool &&other) noexcept = delete;
+
+        ~TexturePool();
+
+        TexturePool &operator=(const TexturePool &other) = delete;
+        TexturePool &operator=(TexturePool &&other) noexcept = delete;
+
+        [[nodiscard]] static std::unique_ptr<TexturePool> create(
+            WGPUDevice device, uint32_t pageSize = 1024, uint32_t layerCount = 4, uint32_t maxTextureSize = 256
+        );
+
+        // Copies are recorded into the given command encoder, which has to be submitted before anything sampling
+        // from the returned region.
+        [[nodiscard]] TextureRegion region(WGPUCommandEncoder commandEncoder, Texture2D &texture);
+
+        void release(Texture2D &texture);
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+
+#include <webgpu.h>
+
+#include "delusion/graphics/Texture2D.hpp"
+#include "delusion/Image.hpp"
+
+// Reads an RGBA8 texture back to the CPU without stalling, e.g. to save offscreen renders or compare them to golden
+// images.
+//
+// Usage: copy() -> (submit) -> read() -> ... the callback runs once the GPU is done, from a device poll.
+// Rows come back in texture order, the same order images are uploaded in, so the result can be encoded directly.
+class TextureReadback {
+    public:
+        using Callback = std::function<void(Image &image)>;
+    private:
+        WGPUDevice m_device;
+        WGPUBuffer m_buffer;
+
+        uint32_t m_width;
+        uint32_t m_height;
+
+        // Buffer copies need rows aligned to 256 bytes, they're tightly packed again once mapped.
+        uint32_t m_paddedBytesPerRow;
+
+        bool m_isReading = false;
+
+        Callback m_callback;
+
+        TextureReadback(
+            WGPUDevice device, WGPUBuffer buffer, uint32_t width, uint32_t height, uint32_t paddedBytesPerRow
+        )
+            : m_device(device), m_buffer(buffer), m_width(width), m_height(height),
+              m_paddedBytesPerRow(paddedBytesPerRow) {}
+    public:
+        TextureReadback(const TextureReadback &other) = delete;
+        TextureReadback(TextureReadback &&other) noexcept = delete;
+
+        ~TextureReadback();
+
+        TextureReadback &operator=(const TextureReadback &other) = delete;
+        TextureReadback &operator=(TextureReadback &&other) noexcept = delete;
+
+        [[nodiscard]] static std::unique_ptr<TextureReadback> create(
+            WGPUDevice device, uint32_t width, uint32_t height
+        );
+
+        // Records a copy of the texture, which has to be the size of the readback.
+        void copy(WGPUCommandEncoder commandEncoder, Texture2D &texture);
+
+        // Starts mapping the last copied texture, after the copy has been submitted.
+        // The callback isn't called if mapping fails.
+        void read(Callback callback);
+
+        // Blocks until the current read has finished and its callback has run.
+        void wait();
+
+        [[nodiscard]] bool isReading() const {
+            return m_isReading;
+        }
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <memory>
+#include <span>
+#include <vector>
+
+#include <webgpu.h>
+
+struct UploadAllocation {
+        WGPUBuffer buffer;
+        uint64_t offset;
+
+        std::span<uint8_t> data;
+};
+
+// Per-frame suballocator for data uploaded to the GPU every frame (uniforms, instance data...).
+//
+// Allocations are carved from a few large buffers, writes land in a CPU-side shadow and are uploaded with a single
+// queue write per buffer on flush. Queue writes are ordered after everything submitted before them, so the buffers are
+// simply reused every frame, without waiting for the GPU.
+//
+// Usage: beginFrame() -> allocate() ... -> flush() -> (record commands, submit) -> beginFrame() -> ...
+// Everything flushed in a frame has to be submitted before the next call to beginFrame().
+class UploadRing {
+    private:
+        struct Chunk {
+                WGPUBuffer buffer;
+                uint64_t size;
+                uint64_t used;
+
+                std::vector<uint8_t> shadow;
+        };
+
+        WGPUDevice m_device;
+        WGPUQueue m_queue;
+
+        WGPUBufferUsageFlags m_usage;
+        uint64_t m_chunkSize;
+
+        std::vector<Chunk> m_chunks;
+
+        uint64_t m_createdBufferCount {};
+
+        UploadRing(WGPUDevice device, WGPUQueue queue, WGPUBufferUsageFlags usage, uint64_t chunkSize);
+    public:
+        UploadRing(const UploadRing &other) = delete;
+        UploadRing(UploadRing &&other) noexcept = delete;
+
+        ~UploadRing();
+
+        UploadRing &operator=(const UploadRing &other) = delete;
+        UploadRing &operator=(UploadRing &&other) noexcept = delete;
+
+        // Usage gets CopyDst added implicitly.
+        [[nodiscard]] static std::unique_ptr<UploadRing> create(
+            WGPUDevice device, WGPUQueue queue, WGPUBufferUsageFlags usage, uint64_t chunkSize
+        );
+
+        // Makes every buffer available for allocations again.
+        void beginFrame();
+
+        [[nodiscard]] UploadAllocation allocate(uint64_t size, uint64_t alignment);
+
+        void flush();
+
+        [[nodiscard]] uint64_t createdBufferCount() const {
+            return m_createdBufferCount;
+        }
+};
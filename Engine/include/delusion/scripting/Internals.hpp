@@ -5,6 +5,7 @@
 #include "delusion/Components.hpp"
 #include "delusion/Engine.hpp"
 #include "delusion/input/Key.hpp"
+#include "delusion/Scene.hpp"
 #include "delusion/UniqueId.hpp"
 
 // Input
@@ -22,17 +23,17 @@ void hasTransformComponent(UniqueId id, bool *result) {
     const auto *engine = Engine::get();
     const auto *scene = engine->currentScene();
     // NOTE: This shouldn't fail unless there's somewhere a really serious bug
-    const auto *entity = scene->getById(id).value();
+    const auto entity = scene->getById(id).value();
 
-    *result = entity->hasComponent<TransformComponent>();
+    *result = entity.hasComponent<TransformComponent>();
 }
 
 void getTransformPosition(UniqueId id, glm::vec2 *result) {
     const auto *engine = Engine::get();
     const auto *scene = engine->currentScene();
     // NOTE: This shouldn't fail unless there's somewhere a really serious bug
-    const auto *entity = scene->getById(id).value();
-    const auto &transform = entity->getComponent<TransformComponent>();
+    const auto entity = scene->getById(id).value();
+    const auto &transform = entity.getComponent<TransformComponent>();
 
     *result = transform.position;
 }
@@ -41,18 +42,17 @@ void setTransformPosition(UniqueId id, glm::vec2 position) {
     auto *engine = Engine::get();
     auto *scene = engine->currentScene();
     // NOTE: This shouldn't fail unless there's somewhere a really serious bug
-    auto *entity = scene->getById(id).value();
-    auto &transform = entity->getComponent<TransformComponent>();
+    auto entity = scene->getById(id).value();
 
-    transform.position = position;
+    entity.patchComponent<TransformComponent>([&](auto &transform) { transform.position = position; });
 }
 
 void getTransformScale(UniqueId id, glm::vec2 *result) {
     const auto *engine = Engine::get();
     const auto *scene = engine->currentScene();
     // NOTE: This shouldn't fail unless there's somewhere a really serious bug
-    const auto *entity = scene->getById(id).value();
-    const auto &transform = entity->getComponent<TransformComponent>();
+    const auto entity = scene->getById(id).value();
+    const auto &transform = entity.getComponent<TransformComponent>();
 
     *result = transform.scale;
 }
@@ -61,18 +61,17 @@ void setTransformScale(UniqueId id, glm::vec2 scale) {
     auto *engine = Engine::get();
     auto *scene = engine->currentScene();
     // NOTE: This shouldn't fail unless there's somewhere a really serious bug
-    auto *entity = scene->getById(id).value();
-    auto &transform = entity->getComponent<TransformComponent>();
+    auto entity = scene->getById(id).value();
 
-    transform.scale = scale;
+    entity.patchComponent<TransformComponent>([&](auto &transform) { transform.scale = scale; });
 }
 
 void getTransformRotation(UniqueId id, float *result) {
     const auto *engine = Engine::get();
     const auto *scene = engine->currentScene();
     // NOTE: This shouldn't fail unless there's somewhere a really serious bug
-    const auto *entity = scene->getById(id).value();
-    const auto &transform = entity->getComponent<TransformComponent>();
+    const auto entity = scene->getById(id).value();
+    const auto &transform = entity.getComponent<TransformComponent>();
 
     *result = transform.rotation;
 }
@@ -81,10 +80,9 @@ void setTransformRotation(UniqueId id, float rotation) {
     auto *engine = Engine::get();
     auto *scene = engine->currentScene();
     // NOTE: This shouldn't fail unless there's somewhere a really serious bug
-    auto *entity = scene->getById(id).value();
-    auto &transform = entity->getComponent<TransformComponent>();
+    auto entity = scene->getById(id).value();
 
-    transform.rotation = rotation;
+    entity.patchComponent<TransformComponent>([&](auto &transform) { transform.rotation = rotation; });
 }
 
 // Sprite component
@@ -92,16 +90,16 @@ void setTransformRotation(UniqueId id, float rotation) {
 void hasSpriteComponent(UniqueId id, bool *result) {
     const auto *engine = Engine::get();
     const auto *scene = engine->currentScene();
-    const auto *entity = scene->getById(id).value();
+    const auto entity = scene->getById(id).value();
 
-    *result = entity->hasComponent<SpriteComponent>();
+    *result = entity.hasComponent<SpriteComponent>();
 }
 
 void getSpriteTexture(UniqueId id, UniqueId *result) {
     const auto *engine = Engine::get();
     const auto *scene = engine->currentScene();
-    const auto *entity = scene->getById(id).value();
-    const auto &sprite = entity->getComponent<SpriteComponent>();
+    const auto entity = scene->getById(id).value();
+    const auto &sprite = entity.getComponent<SpriteComponent>();
 
     *result = sprite.texture->id();
 }
@@ -109,10 +107,10 @@ void getSpriteTexture(UniqueId id, UniqueId *result) {
 void setSpriteTexture(UniqueId id, UniqueId textureId) {
     auto *engine = Engine::get();
     auto *scene = engine->currentScene();
-    auto *entity = scene->getById(id).value();
-    auto &sprite = entity->getComponent<SpriteComponent>();
-
-    sprite.texture = engine->assetManager()->getTextureById(textureId);
+    auto entity = scene->getById(id).value();
+    entity.patchComponent<SpriteComponent>([&](auto &sprite) {
+        sprite.texture = engine->assetManager()->getTextureById(textureId);
+    });
 }
 
 // Rigidbody component
@@ -120,16 +118,16 @@ void setSpriteTexture(UniqueId id, UniqueId textureId) {
 void hasRigidbodyComponent(UniqueId id, bool *result) {
     const auto *engine = Engine::get();
     const auto *scene = engine->currentScene();
-    const auto *entity = scene->getById(id).value();
+    const auto entity = scene->getById(id).value();
 
-    *result = entity->hasComponent<RigidbodyComponent>();
+    *result = entity.hasComponent<RigidbodyComponent>();
 }
 
 void getRigidbodyBodyType(UniqueId id, RigidbodyComponent::BodyType *result) {
     const auto *engine = Engine::get();
     const auto *scene = engine->currentScene();
-    const auto *entity = scene->getById(id).value();
-    const auto &rigidbody = entity->getComponent<RigidbodyComponent>();
+    const auto entity = scene->getById(id).value();
+    const auto &rigidbody = entity.getComponent<RigidbodyComponent>();
 
     *result = rigidbody.bodyType;
 }
@@ -137,17 +135,15 @@ void getRigidbodyBodyType(UniqueId id, RigidbodyComponent::BodyType *result) {
 void setRigidbodyBodyType(UniqueId id, RigidbodyComponent::BodyType bodyType) {
     auto *engine = Engine::get();
     auto *scene = engine->currentScene();
-    auto *entity = scene->getById(id).value();
-    auto &rigidbody = entity->getComponent<RigidbodyComponent>();
-
-    rigidbody.bodyType = bodyType;
+    auto entity = scene->getById(id).value();
+    entity.patchComponent<RigidbodyComponent>([&](auto &rigidbody) { rigidbody.bodyType = bodyType; });
 }
 
 void getRigidbodyHasFixedRotation(UniqueId id, bool *result) {
     const auto *engine = Engine::get();
     const auto *scene = engine->currentScene();
-    const auto *entity = scene->getById(id).value();
-    const auto &rigidbody = entity->getComponent<RigidbodyComponent>();
+    const auto entity = scene->getById(id).value();
+    const auto &rigidbody = entity.getComponent<RigidbodyComponent>();
 
     *result = rigidbody.hasFixedRotation;
 }
@@ -155,18 +151,16 @@ void getRigidbodyHasFixedRotation(UniqueId id, bool *result) {
 void setRigidbodyHasFixedRotation(UniqueId id, bool hasFixedRotation) {
     auto *engine = Engine::get();
     auto *scene = engine->currentScene();
-    auto *entity = scene->getById(id).value();
-    auto &rigidbody = entity->getComponent<RigidbodyComponent>();
-
-    rigidbody.hasFixedRotation = hasFixedRotation;
+    auto entity = scene->getById(id).value();
+    entity.patchComponent<RigidbodyComponent>([&](auto &rigidbody) { rigidbody.hasFixedRotation = hasFixedRotation; });
 }
 
 void getRigidbodyFriction(UniqueId id, float *result) {
     const auto *engine = Engine::get();
     const auto *scene = engine->currentScene();
     // NOTE: This shouldn't fail unless there's somewhere a really serious bug
-    const auto *entity = scene->getById(id).value();
-    const auto &rigidbody = entity->getComponent<RigidbodyComponent>();
+    const auto entity = scene->getById(id).value();
+    const auto &rigidbody = entity.getComponent<RigidbodyComponent>();
 
     *result = rigidbody.friction;
 }
@@ -175,18 +169,16 @@ void setRigidbodyFriction(UniqueId id, float friction) {
     auto *engine = Engine::get();
     auto *scene = engine->currentScene();
     // NOTE: This shouldn't fail unless there's somewhere a really serious bug
-    auto *entity = scene->getById(id).value();
-    auto &rigidbody = entity->getComponent<RigidbodyComponent>();
-
-    rigidbody.friction = friction;
+    auto entity = scene->getById(id).value();
+    entity.patchComponent<RigidbodyComponent>([&](auto &rigidbody) { rigidbody.friction = friction; });
 }
 
 void getRigidbodyDensity(UniqueId id, float *result) {
     const auto *engine = Engine::get();
     const auto *scene = engine->currentScene();
     // NOTE: This shouldn't fail unless there's somewhere a really serious bug
-    const auto *entity = scene->getById(id).value();
-    const auto &rigidbody = entity->getComponent<RigidbodyComponent>();
+    const auto entity = scene->getById(id).value();
+    const auto &rigidbody = entity.getComponent<RigidbodyComponent>();
 
     *result = rigidbody.density;
 }
@@ -195,18 +187,16 @@ void setRigidbodyDensity(UniqueId id, float density) {
     auto *engine = Engine::get();
     auto *scene = engine->currentScene();
     // NOTE: This shouldn't fail unless there's somewhere a really serious bug
-    auto *entity = scene->getById(id).value();
-    auto &rigidbody = entity->getComponent<RigidbodyComponent>();
-
-    rigidbody.density = density;
+    auto entity = scene->getById(id).value();
+    entity.patchComponent<RigidbodyComponent>([&](auto &rigidbody) { rigidbody.density = density; });
 }
 
 void getRigidbodyRestitution(UniqueId id, float *result) {
     const auto *engine = Engine::get();
     const auto *scene = engine->currentScene();
     // NOTE: This shouldn't fail unless there's somewhere a really serious bug
-    const auto *entity = scene->getById(id).value();
-    const auto &rigidbody = entity->getComponent<RigidbodyComponent>();
+    const auto entity = scene->getById(id).value();
+    const auto &rigidbody = entity.getComponent<RigidbodyComponent>();
 
     *result = rigidbody.restitution;
 }
@@ -215,18 +205,16 @@ void setRigidbodyRestitution(UniqueId id, float restitution) {
     auto *engine = Engine::get();
     auto *scene = engine->currentScene();
     // NOTE: This shouldn't fail unless there's somewhere a really serious bug
-    auto *entity = scene->getById(id).value();
-    auto &rigidbody = entity->getComponent<RigidbodyComponent>();
-
-    rigidbody.restitution = restitution;
+    auto entity = scene->getById(id).value();
+    entity.patchComponent<RigidbodyComponent>([&](auto &rigidbody) { rigidbody.restitution = restitution; });
 }
 
 void getRigidbodyRestitutionThreshold(UniqueId id, float *result) {
     const auto *engine = Engine::get();
     const auto *scene = engine->currentScene();
     // NOTE: This shouldn't fail unless there's somewhere a really serious bug
-    const auto *entity = scene->getById(id).value();
-    const auto &rigidbody = entity->getComponent<RigidbodyComponent>();
+    const auto entity = scene->getById(id).value();
+    const auto &rigidbody = entity.getComponent<RigidbodyComponent>();
 
     *result = rigidbody.restitutionThreshold;
 }
@@ -235,10 +223,10 @@ void setRigidbodyRestitutionThreshold(UniqueId id, float restitutionThreshold) {
     auto *engine = Engine::get();
     auto *scene = engine->currentScene();
     // NOTE: This shouldn't fail unless there's somewhere a really serious bug
-    auto *entity = scene->getById(id).value();
-    auto &rigidbody = entity->getComponent<RigidbodyComponent>();
-
-    rigidbody.restitutionThreshold = restitutionThreshold;
+    auto entity = scene->getById(id).value();
+    entity.patchComponent<RigidbodyComponent>([&](auto &rigidbody) {
+        rigidbody.restitutionThreshold = restitutionThreshold;
+    });
 }
 
 // Box collider component
@@ -246,17 +234,17 @@ void setRigidbodyRestitutionThreshold(UniqueId id, float restitutionThreshold) {
 void hasBoxColliderComponent(UniqueId id, bool *result) {
     const auto *engine = Engine::get();
     const auto *scene = engine->currentScene();
-    const auto *entity = scene->getById(id).value();
+    const auto entity = scene->getById(id).value();
 
-    *result = entity->hasComponent<BoxColliderComponent>();
+    *result = entity.hasComponent<BoxColliderComponent>();
 }
 
 void getBoxColliderSize(UniqueId id, glm::vec2 *result) {
     const auto *engine = Engine::get();
     const auto *scene = engine->currentScene();
     // NOTE: This shouldn't fail unless there's somewhere a really serious bug
-    const auto *entity = scene->getById(id).value();
-    const auto &boxCollider = entity->getComponent<BoxColliderComponent>();
+    const auto entity = scene->getById(id).value();
+    const auto &boxCollider = entity.getComponent<BoxColliderComponent>();
 
     *result = boxCollider.size;
 }
@@ -265,18 +253,16 @@ void setBoxColliderSize(UniqueId id, glm::vec2 size) {
     auto *engine = Engine::get();
     auto *scene = engine->currentScene();
     // NOTE: This shouldn't fail unless there's somewhere a really serious bug
-    auto *entity = scene->getById(id).value();
-    auto &boxCollider = entity->getComponent<BoxColliderComponent>();
-
-    boxCollider.size = size;
+    auto entity = scene->getById(id).value();
+    entity.patchComponent<BoxColliderComponent>([&](auto &boxCollider) { boxCollider.size = size; });
 }
 
 void getBoxColliderOffset(UniqueId id, glm::vec2 *result) {
     const auto *engine = Engine::get();
     const auto *scene = engine->currentScene();
     // NOTE: This shouldn't fail unless there's somewhere a really serious bug
-    const auto *entity = scene->getById(id).value();
-    const auto &boxCollider = entity->getComponent<BoxColliderComponent>();
+    const auto entity = scene->getById(id).value();
+    const auto &boxCollider = entity.getComponent<BoxColliderComponent>();
 
     *result = boxCollider.offset;
 }
@@ -285,8 +271,36 @@ void setBoxColliderOffset(UniqueId id, glm::vec2 offset) {
     auto *engine = Engine::get();
     auto *scene = engine->currentScene();
     // NOTE: This shouldn't fail unless there's somewhere a really serious bug
-    auto *entity = scene->getById(id).value();
-    auto &boxCollider = entity->getComponent<BoxColliderComponent>();
+    auto entity = scene->getById(id).value();
+    entity.patchComponent<BoxColliderComponent>([&](auto &boxCollider) { boxCollider.offset = offset; });
+}
+
+// Physics queries
+
+void queryOverlaps(
+    const BoundingBox *queries, uint32_t queryCount, UniqueId *results, uint32_t resultCapacity,
+    uint32_t *resultCounts, uint32_t *result
+) {
+    auto *engine = Engine::get();
+    auto *scene = engine->currentScene();
+
+    auto resultCount = scene->queryOverlaps(
+        { queries, queryCount }, { results, resultCapacity }, { resultCounts, queryCount }
+    );
+
+    *result = static_cast<uint32_t>(resultCount);
+}
+
+void raycast(const RaycastQuery *queries, uint32_t queryCount, QueryHit *hits) {
+    auto *engine = Engine::get();
+    auto *scene = engine->currentScene();
+
+    scene->raycast({ queries, queryCount }, { hits, queryCount });
+}
+
+void boxCast(const BoxCastQuery *queries, uint32_t queryCount, QueryHit *hits) {
+    auto *engine = Engine::get();
+    auto *scene = engine->currentScene();
 
-    boxCollider.offset = offset;
+    scene->boxCast({ queries, queryCount }, { hits, queryCount });
 }
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads pulling tasks from a shared queue.
+class ThreadPool {
+    private:
+        std::vector<std::thread> m_threads;
+
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        std::deque<std::function<void()>> m_tasks;
+
+        bool m_isStopping = false;
+    public:
+        explicit ThreadPool(size_t threadCount);
+
+        ThreadPool(const ThreadPool &other) = delete;
+        ThreadPool(ThreadPool &&other) noexcept = delete;
+
+        // Finishes queued tasks before joining the workers.
+        ~ThreadPool();
+
+        ThreadPool &operator=(const ThreadPool &other) = delete;
+        ThreadPool &operator=(ThreadPool &&other) noexcept = delete;
+
+        void submit(std::function<void()> task);
+
+        // Calls the task for every index in [0, count), spread over the workers and the calling thread.
+        // Returns once every call has finished.
+        void parallelFor(size_t count, const std::function<void(size_t)> &task);
+
+        [[nodiscard]] size_t threadCount() const {
+            return m_threads.size();
+        }
+    private:
+        void work();
+};
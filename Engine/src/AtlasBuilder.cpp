@@ -0,0 +1,269 @@
+#include "delusion/AtlasBuilder.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <format>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "delusion/formats/ImageDecoder.hpp"
+#include "delusion/formats/ImageEncoder.hpp"
+#include "delusion/graphics/SkylinePacker.hpp"
+#include "delusion/io/FileUtilities.hpp"
+#include "delusion/MetadataSerde.hpp"
+
+// Gap around every image, filled with its edge pixels so filtering never picks up texels of neighbouring images.
+static constexpr uint32_t s_padding = 2;
+
+// A texel of mip level n covers 2^n texels of the page, past the levels the padding covers every image blends with its
+// neighbours. Pages are limited to those levels rather than padded further.
+static constexpr uint32_t s_pageMipLevelCount = std::bit_width(s_padding);
+
+static constexpr const char *s_atlasMarkerFileName = ".atlas";
+static constexpr const char *s_outputDirectoryName = "atlases";
+
+struct AtlasEntry {
+        std::filesystem::path metadataPath;
+        Metadata metadata;
+        Image image;
+
+        size_t pageIndex {};
+        PackedPosition position {};
+};
+
+struct AtlasPage {
+        SkylinePacker packer;
+
+        uint32_t usedWidth {};
+        uint32_t usedHeight {};
+};
+
+static std::filesystem::path metadataPathOf(const std::filesystem::path &path) {
+    auto metadataPath = path;
+
+    metadataPath.replace_extension(std::format("{}.{}", path.extension().string(), "metadata"));
+
+    return metadataPath;
+}
+
+static void writeMetadata(const std::filesystem::path &metadataPath, const Metadata &metadata) {
+    std::ofstream stream(metadataPath);
+
+    stream << MetadataSerde::serialize(metadata);
+}
+
+static void collectEntries(
+    const std::filesystem::path &directoryPath, const std::filesystem::path &outputDirectoryPath,
+    std::map<std::string, std::vector<AtlasEntry>> &atlases
+) {
+    bool isAtlasDirectory = std::filesystem::exists(directoryPath / s_atlasMarkerFileName);
+
+    for (const auto &entry : std::filesystem::directory_iterator(directoryPath)) {
+        if (entry.is_directory()) {
+            if (entry.path() != outputDirectoryPath) {
+                collectEntries(entry.path(), outputDirectoryPath, atlases);
+            }
+
+            continue;
+        }
+
+        if (entry.path().extension() != ".png")
+            continue;
+
+        auto metadataPath = metadataPathOf(entry.path());
+        auto metadataContent = readAsString(metadataPath);
+
+        if (!metadataContent.has_value())
+            continue;
+
+        Metadata metadata = MetadataSerde::deserialize(metadataContent.value());
+
+        std::optional<std::string> atlas = metadata.atlas;
+
+        if (!atlas.has_value() && isAtlasDirectory) {
+            atlas = directoryPath.filename().string();
+        }
+
+        if (!atlas.has_value()) {
+            // No longer part of an atlas
+            if (metadata.atlasRegion.has_value()) {
+                metadata.atlasRegion = std::nullopt;
+
+                writeMetadata(metadataPath, metadata);
+            }
+
+            continue;
+        }
+
+        atlases[atlas.value()].push_back(AtlasEntry {
+            .metadataPath = metadataPath,
+            .metadata = metadata,
+            .image = ImageDecoder::decode(entry.path().string()),
+        });
+    }
+}
+
+// Copies the image and extrudes its edges into the padding around it.
+static void blit(Image &page, Image &image, uint32_t x, uint32_t y) {
+    auto padding = static_cast<int64_t>(s_padding);
+    auto width = static_cast<int64_t>(image.width());
+    auto height = static_cast<int64_t>(image.height());
+
+    auto pagePixels = page.pixels();
+    auto imagePixels = image.pixels();
+
+    for (int64_t row = -padding; row < height + padding; row++) {
+        for (int64_t column = -padding; column < width + padding; column++) {
+            auto sourceColumn = std::clamp<int64_t>(column, 0, width - 1);
+            auto sourceRow = std::clamp<int64_t>(row, 0, height - 1);
+
+            auto sourceIndex = static_cast<size_t>(sourceRow * width + sourceColumn) * 4;
+            auto destinationIndex =
+                (static_cast<size_t>(y + row) * page.width() + static_cast<size_t>(x + column)) * 4;
+
+            std::copy_n(imagePixels.begin() + sourceIndex, 4, pagePixels.begin() + destinationIndex);
+        }
+    }
+}
+
+static void buildAtlas(
+    const std::string &name, std::vector<AtlasEntry> &entries, const std::filesystem::path &outputDirectoryPath,
+    uint32_t maxPageSize
+) {
+    // Tallest first packs noticeably tighter with a skyline, path order keeps the output stable between builds.
+    std::sort(entries.begin(), entries.end(), [](const AtlasEntry &left, const AtlasEntry &right) {
+        if (left.image.height() != right.image.height())
+            return left.image.height() > right.image.height();
+
+        return left.metadataPath < right.metadataPath;
+    });
+
+    std::vector<AtlasPage> pages;
+    std::vector<AtlasEntry *> packedEntries;
+
+    for (auto &entry : entries) {
+        uint32_t paddedWidth = entry.image.width() + 2 * s_padding;
+        uint32_t paddedHeight = entry.image.height() + 2 * s_padding;
+
+        if (paddedWidth > maxPageSize || paddedHeight > maxPageSize) {
+            // Too large, keeps being loaded on its own
+            if (entry.metadata.atlasRegion.has_value()) {
+                entry.metadata.atlasRegion = std::nullopt;
+
+                writeMetadata(entry.metadataPath, entry.metadata);
+            }
+
+            continue;
+        }
+
+        std::optional<PackedPosition> position;
+
+        for (size_t pageIndex = 0; pageIndex < pages.size() && !position.has_value(); pageIndex++) {
+            position = pages[pageIndex].packer.pack(paddedWidth, paddedHeight);
+            entry.pageIndex = pageIndex;
+        }
+
+        if (!position.has_value()) {
+            pages.push_back(AtlasPage { .packer = SkylinePacker(maxPageSize, maxPageSize) });
+
+            position = pages.back().packer.pack(paddedWidth, paddedHeight);
+            entry.pageIndex = pages.size() - 1;
+        }
+
+        auto &page = pages[entry.pageIndex];
+
+        page.usedWidth = std::max(page.usedWidth, position->x + paddedWidth);
+        page.usedHeight = std::max(page.usedHeight, position->y + paddedHeight);
+
+        entry.position = PackedPosition { position->x + s_padding, position->y + s_padding };
+
+        packedEntries.push_back(&entry);
+    }
+
+    // Pages are shrunk to the smallest power of two still covering everything packed into them.
+    std::vector<Image> pageImages;
+    std::vector<UniqueId> pageIds;
+
+    for (size_t pageIndex = 0; pageIndex < pages.size(); pageIndex++) {
+        uint32_t width = std::bit_ceil(pages[pageIndex].usedWidth);
+        uint32_t height = std::bit_ceil(pages[pageIndex].usedHeight);
+
+        pageImages.emplace_back(width, height, std::vector<uint8_t>(static_cast<size_t>(width) * height * 4));
+
+        // Pages keep their ids between builds, so references to them stay valid.
+        auto pagePath = outputDirectoryPath / std::format("{}_{}.png", name, pageIndex);
+        auto pageMetadataPath = metadataPathOf(pagePath);
+        auto pageMetadataContent = readAsString(pageMetadataPath);
+
+        Metadata pageMetadata;
+
+        if (pageMetadataContent.has_value()) {
+            pageMetadata = MetadataSerde::deserialize(pageMetadataContent.value());
+        }
+
+        if (!pageMetadataContent.has_value() || pageMetadata.mipLevelCount != s_pageMipLevelCount) {
+            pageMetadata.mipLevelCount = s_pageMipLevelCount;
+
+            writeMetadata(pageMetadataPath, pageMetadata);
+        }
+
+        pageIds.push_back(pageMetadata.id);
+    }
+
+    for (auto *entry : packedEntries) {
+        auto &pageImage = pageImages[entry->pageIndex];
+
+        blit(pageImage, entry->image, entry->position.x, entry->position.y);
+
+        auto pageWidth = static_cast<float>(pageImage.width());
+        auto pageHeight = static_cast<float>(pageImage.height());
+
+        entry->metadata.atlasRegion = AtlasRegion {
+            .page = pageIds[entry->pageIndex],
+            .uvRect = glm::vec4(
+                static_cast<float>(entry->position.x) / pageWidth, static_cast<float>(entry->position.y) / pageHeight,
+                static_cast<float>(entry->image.width()) / pageWidth,
+                static_cast<float>(entry->image.height()) / pageHeight
+            ),
+        };
+
+        writeMetadata(entry->metadataPath, entry->metadata);
+    }
+
+    for (size_t pageIndex = 0; pageIndex < pageImages.size(); pageIndex++) {
+        auto pagePath = outputDirectoryPath / std::format("{}_{}.png", name, pageIndex);
+
+        ImageEncoder::encode(pagePath.string(), pageImages[pageIndex]);
+    }
+
+    // Pages left over from a previous, larger build
+    for (size_t pageIndex = pageImages.size();; pageIndex++) {
+        auto pagePath = outputDirectoryPath / std::format("{}_{}.png", name, pageIndex);
+
+        if (!std::filesystem::exists(pagePath))
+            break;
+
+        std::filesystem::remove(pagePath);
+        std::filesystem::remove(metadataPathOf(pagePath));
+    }
+}
+
+void AtlasBuilder::build(const std::filesystem::path &rootPath, uint32_t maxPageSize) {
+    auto outputDirectoryPath = rootPath / s_outputDirectoryName;
+
+    std::map<std::string, std::vector<AtlasEntry>> atlases;
+
+    collectEntries(rootPath, outputDirectoryPath, atlases);
+
+    if (atlases.empty())
+        return;
+
+    std::filesystem::create_directories(outputDirectoryPath);
+
+    for (auto &[name, entries] : atlases) {
+        buildAtlas(name, entries, outputDirectoryPath, maxPageSize);
+    }
+}
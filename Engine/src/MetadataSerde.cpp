@@ -3,7 +3,34 @@
 Metadata MetadataSerde::deserialize(const std::string &input) {
     YAML::Node node = YAML::Load(input);
 
-    return Metadata { UniqueId(node["unique_id"].as<uint64_t>()) };
+    Metadata metadata { UniqueId(node["unique_id"].as<uint64_t>()) };
+
+    auto atlasNode = node["atlas"];
+
+    if (atlasNode) {
+        metadata.atlas = atlasNode.as<std::string>();
+    }
+
+    auto atlasPageNode = node["atlas_page"];
+    auto uvRectNode = node["uv_rect"];
+
+    if (atlasPageNode && uvRectNode) {
+        metadata.atlasRegion = AtlasRegion {
+            .page = UniqueId(atlasPageNode.as<uint64_t>()),
+            .uvRect = glm::vec4(
+                uvRectNode["x"].as<float>(), uvRectNode["y"].as<float>(), uvRectNode["width"].as<float>(),
+                uvRectNode["height"].as<float>()
+            ),
+        };
+    }
+
+    auto mipLevelCountNode = node["mip_level_count"];
+
+    if (mipLevelCountNode) {
+        metadata.mipLevelCount = mipLevelCountNode.as<uint32_t>();
+    }
+
+    return metadata;
 }
 
 std::string MetadataSerde::serialize(const Metadata &metadata) {
@@ -14,6 +41,40 @@ std::string MetadataSerde::serialize(const Metadata &metadata) {
     emitter << YAML::Key << "unique_id";
     emitter << YAML::Value << metadata.id.value();
 
+    if (metadata.atlas.has_value()) {
+        emitter << YAML::Key << "atlas";
+        emitter << YAML::Value << metadata.atlas.value();
+    }
+
+    if (metadata.atlasRegion.has_value()) {
+        const auto &atlasRegion = metadata.atlasRegion.value();
+
+        emitter << YAML::Key << "atlas_page";
+        emitter << YAML::Value << atlasRegion.page.value();
+
+        emitter << YAML::Key << "uv_rect";
+        emitter << YAML::BeginMap;
+
+        emitter << YAML::Key << "x";
+        emitter << YAML::Value << atlasRegion.uvRect.x;
+
+        emitter << YAML::Key << "y";
+        emitter << YAML::Value << atlasRegion.uvRect.y;
+
+        emitter << YAML::Key << "width";
+        emitter << YAML::Value << atlasRegion.uvRect.z;
+
+        emitter << YAML::Key << "height";
+        emitter << YAML::Value << atlasRegion.uvRect.w;
+
+        emitter << YAML::EndMap;
+    }
+
+    if (metadata.mipLevelCount.has_value()) {
+        emitter << YAML::Key << "mip_level_count";
+        emitter << YAML::Value << metadata.mipLevelCount.value();
+    }
+
     emitter << YAML::EndMap;
 
     return { emitter.c_str() };
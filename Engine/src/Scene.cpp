@@ -1,304 +1,916 @@
 #include "delusion/Scene.hpp"
 
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <glm/matrix.hpp>
+
 #include "delusion/Components.hpp"
 
-Scene::Scene(Scene &&other) noexcept {
-    m_entities = std::move(other.m_entities);
+// Shared by every scene, so a renderer switching between scenes never mistakes one scene's version for another's.
+static uint64_t s_lastStaticSpritesVersion = 0;
 
-    m_registry = std::move(other.m_registry);
+static bool isStaticSprite(entt::registry &registry, entt::entity entity) {
+    auto *sprite = registry.try_get<SpriteComponent>(entity);
+
+    return sprite != nullptr && sprite->isStatic && registry.all_of<WorldTransformComponent>(entity);
+}
+
+static void indexEntity(EntityIndex &index, entt::registry &registry, entt::entity entity) {
+    index.entities[registry.get<IdComponent>(entity).id] = entity;
+}
 
-    for (auto &entity : m_entities) {
-        updateRegistry(entity, &m_registry);
+static void unindexEntity(EntityIndex &index, entt::registry &registry, entt::entity entity) {
+    auto result = index.entities.find(registry.get<IdComponent>(entity).id);
+
+    // Only if the id hasn't been taken over by another entity since
+    if (result != index.entities.end() && result->second == entity) {
+        index.entities.erase(result);
     }
+}
 
-    m_physicsWorld = std::move(other.m_physicsWorld);
+static void markTransformDirty(TransformTracking &transforms, entt::registry &, entt::entity entity) {
+    transforms.dirty.insert(entity);
 }
 
-Scene &Scene::operator=(Scene &&other) noexcept {
-    m_entities = std::move(other.m_entities);
+// Without a local transform there's nothing to derive a world transform from.
+static void removeWorldTransform(TransformTracking &transforms, entt::registry &registry, entt::entity entity) {
+    transforms.dirty.insert(entity);
 
-    m_registry = std::move(other.m_registry);
+    registry.remove<WorldTransformComponent>(entity);
+}
 
-    for (auto &entity : m_entities) {
-        updateRegistry(entity, &m_registry);
+static void markBodyMoved(PhysicsTracking &physics, entt::registry &registry, entt::entity entity) {
+    if (!physics.isWritingBack && registry.all_of<RigidbodyComponent>(entity)) {
+        physics.movedBodies.insert(entity);
     }
+}
 
-    m_physicsWorld = std::move(other.m_physicsWorld);
+static void createBodyLater(PhysicsTracking &physics, entt::registry &, entt::entity entity) {
+    if (physics.isSimulating) {
+        physics.bodiesToCreate.insert(entity);
+    }
+}
 
-    return *this;
+// Still attached while the destroy signal runs
+static void destroyBodyLater(PhysicsTracking &physics, entt::registry &registry, entt::entity entity) {
+    physics.movedBodies.erase(entity);
+    physics.bodiesToCreate.erase(entity);
+    physics.bodiesToUpdate.erase(entity);
+    physics.fixturesToRebuild.erase(entity);
+
+    registry.remove<PreviousWorldTransformComponent>(entity);
+
+    auto &rigidbody = registry.get<RigidbodyComponent>(entity);
+
+    if (rigidbody.body != nullptr) {
+        physics.bodiesToDestroy.push_back(static_cast<b2Body *>(rigidbody.body));
+
+        rigidbody.body = nullptr;
+        rigidbody.fixture = nullptr;
+    }
 }
 
-Scene Scene::copy(Scene &source) {
-    Scene copiedScene;
+// Changed settings are applied to the existing body and fixture, the body keeps its pose and velocity.
+static void updateBodyLater(PhysicsTracking &physics, entt::registry &registry, entt::entity entity) {
+    if (!physics.isSimulating)
+        return;
+
+    // A replaced rigidbody comes without a body
+    if (registry.get<RigidbodyComponent>(entity).body == nullptr) {
+        physics.bodiesToCreate.insert(entity);
+    } else {
+        physics.bodiesToUpdate.insert(entity);
+    }
+}
 
-    for (auto &entity : source.entities()) {
-        auto &copiedEntity = copiedScene.create();
+// Fixtures are made from the collider, changing it only replaces the body's fixture.
+static void rebuildFixtureLater(PhysicsTracking &physics, entt::registry &registry, entt::entity entity) {
+    if (physics.isSimulating && registry.all_of<RigidbodyComponent>(entity)) {
+        physics.fixturesToRebuild.insert(entity);
+    }
+}
 
-        copyEntity(copiedEntity, entity);
+static b2BodyType toBodyType(RigidbodyComponent::BodyType bodyType) {
+    switch (bodyType) {
+        case RigidbodyComponent::BodyType::Static:
+            return b2BodyType::b2_staticBody;
+        case RigidbodyComponent::BodyType::Dynamic:
+            return b2BodyType::b2_dynamicBody;
+        case RigidbodyComponent::BodyType::Kinematic:
+            return b2BodyType::b2_kinematicBody;
+        default:
+            assert(false);
+
+            return b2BodyType::b2_staticBody;
     }
+}
 
-    return copiedScene;
+template <typename Component>
+static void updateSprite(SpriteTracking &sprites, entt::registry &registry, entt::entity entity) {
+    if (!registry.all_of<WorldTransformComponent, SpriteComponent>(entity))
+        return;
+
+    sprites.index.insert(entity, Scene::spriteBounds(registry.get<WorldTransformComponent>(entity)));
+
+    // A patched sprite may have just stopped being static, so any sprite change counts.
+    if constexpr (std::is_same_v<Component, SpriteComponent>) {
+        sprites.staticVersion = ++s_lastStaticSpritesVersion;
+    } else if (isStaticSprite(registry, entity)) {
+        sprites.staticVersion = ++s_lastStaticSpritesVersion;
+    }
 }
 
-void Scene::start() {
-    m_physicsWorld = std::unique_ptr<b2World>(new b2World({ 0.0f, -10.0f }));
+static void removeSprite(SpriteTracking &sprites, entt::registry &registry, entt::entity entity) {
+    // Still attached while the destroy signal runs
+    if (isStaticSprite(registry, entity)) {
+        sprites.staticVersion = ++s_lastStaticSpritesVersion;
+    }
 
-    auto view = m_registry.view<TransformComponent, RigidbodyComponent>();
+    sprites.index.remove(entity);
+}
 
-    for (auto entity : view) {
-        auto [transform, rigidbody] = view.get<TransformComponent, RigidbodyComponent>(entity);
+// Copies every component of the type in one batch. Entities keep their identifiers between the registries, so
+// components referring to other entities (e.g. the hierarchy) stay valid as they are.
+template <typename Component>
+static void copyComponents(const entt::registry &source, entt::registry &target) {
+    auto view = source.view<const Component>();
 
-        b2BodyType bodyType {};
+    std::vector<entt::entity> entities(view.begin(), view.end());
+    std::vector<Component> components;
 
-        switch (rigidbody.bodyType) {
-            case RigidbodyComponent::BodyType::Static:
-                bodyType = b2BodyType::b2_staticBody;
+    components.reserve(entities.size());
 
-                break;
-            case RigidbodyComponent::BodyType::Dynamic:
-                bodyType = b2BodyType::b2_dynamicBody;
+    for (auto entity : entities) {
+        components.push_back(source.get<Component>(entity));
+    }
 
-                break;
-            case RigidbodyComponent::BodyType::Kinematic:
-                bodyType = b2BodyType::b2_kinematicBody;
+    target.insert<Component>(entities.begin(), entities.end(), components.begin());
+}
 
-                break;
-            default:
-                assert(false);
+// Adapts a lambda to Box2D's fixture query interface.
+template <typename Function>
+class FixtureQuery : public b2QueryCallback {
+    private:
+        Function m_function;
+    public:
+        explicit FixtureQuery(Function function) : m_function(std::move(function)) {}
 
-                break;
+        bool ReportFixture(b2Fixture *fixture) override {
+            return m_function(fixture);
+        }
+};
+
+// Adapts a lambda to Box2D's raycast interface.
+template <typename Function>
+class FixtureRaycast : public b2RayCastCallback {
+    private:
+        Function m_function;
+    public:
+        explicit FixtureRaycast(Function function) : m_function(std::move(function)) {}
+
+        float ReportFixture(b2Fixture *fixture, const b2Vec2 &point, const b2Vec2 &normal, float fraction) override {
+            return m_function(fixture, point, normal, fraction);
         }
+};
 
-        b2BodyDef bodyDefinition {};
-        bodyDefinition.type = bodyType;
-        bodyDefinition.fixedRotation = rigidbody.hasFixedRotation;
-        bodyDefinition.position.Set(transform.position.x, transform.position.y);
-        bodyDefinition.angle = transform.rotation;
+// Id of the entity owning the fixture, bodies of entities removed since the last step are still in the world.
+static const IdComponent *idOfFixture(const entt::registry &registry, const b2Fixture *fixture) {
+    auto entity = static_cast<entt::entity>(fixture->GetBody()->GetUserData().pointer);
 
-        b2Body *body = m_physicsWorld->CreateBody(&bodyDefinition);
+    if (!registry.valid(entity))
+        return nullptr;
 
-        rigidbody.body = static_cast<void *>(body);
+    return registry.try_get<IdComponent>(entity);
+}
 
-        b2FixtureDef fixtureDefinition {};
-        fixtureDefinition.density = rigidbody.density;
-        fixtureDefinition.friction = rigidbody.friction;
-        fixtureDefinition.restitution = rigidbody.restitution;
-        fixtureDefinition.restitutionThreshold = rigidbody.restitutionThreshold;
+// Local transform, scaling first, then rotating clockwise and translating, like sprites are drawn.
+static glm::mat3 localMatrix(const TransformComponent &transform) {
+    auto cos = std::cos(transform.rotation);
+    auto sin = std::sin(transform.rotation);
 
-        b2Fixture *fixture;
+    return {
+        glm::vec3(cos * transform.scale.x, -sin * transform.scale.x, 0.0f),
+        glm::vec3(sin * transform.scale.y, cos * transform.scale.y, 0.0f),
+        glm::vec3(transform.position, 1.0f),
+    };
+}
 
-        if (m_registry.any_of<BoxColliderComponent>(entity)) {
-            auto &collider = m_registry.get<BoxColliderComponent>(entity);
+BoundingBox Scene::spriteBounds(const WorldTransformComponent &transform) {
+    auto cos = std::abs(std::cos(transform.rotation));
+    auto sin = std::abs(std::sin(transform.rotation));
 
-            b2PolygonShape boxShape;
-            boxShape.SetAsBox(transform.scale.x * collider.size.x * 0.5f, transform.scale.y * collider.size.y * 0.5f);
+    auto width = std::abs(transform.scale.x);
+    auto height = std::abs(transform.scale.y);
 
-            fixtureDefinition.shape = &boxShape;
+    glm::vec2 halfExtents = 0.5f * glm::vec2(width * cos + height * sin, width * sin + height * cos);
 
-            fixture = body->CreateFixture(&fixtureDefinition);
-        } else {
-            fixture = body->CreateFixture(&fixtureDefinition);
-        }
+    return { transform.position - halfExtents, transform.position + halfExtents };
+}
+
+Scene::Scene()
+    : m_index(std::make_unique<EntityIndex>()), m_transforms(std::make_unique<TransformTracking>()),
+      m_physics(std::make_unique<PhysicsTracking>()), m_sprites(std::make_unique<SpriteTracking>()) {
+    m_sprites->staticVersion = ++s_lastStaticSpritesVersion;
+
+    m_registry.on_construct<IdComponent>().connect<&indexEntity>(*m_index);
+    m_registry.on_destroy<IdComponent>().connect<&unindexEntity>(*m_index);
+
+    m_registry.on_construct<TransformComponent>().connect<&markTransformDirty>(*m_transforms);
+    m_registry.on_update<TransformComponent>().connect<&markTransformDirty>(*m_transforms);
+    m_registry.on_destroy<TransformComponent>().connect<&removeWorldTransform>(*m_transforms);
+
+    m_registry.on_construct<WorldTransformComponent>().connect<&markBodyMoved>(*m_physics);
+    m_registry.on_update<WorldTransformComponent>().connect<&markBodyMoved>(*m_physics);
+    m_registry.on_construct<RigidbodyComponent>().connect<&createBodyLater>(*m_physics);
+    m_registry.on_update<RigidbodyComponent>().connect<&updateBodyLater>(*m_physics);
+    m_registry.on_destroy<RigidbodyComponent>().connect<&destroyBodyLater>(*m_physics);
+    m_registry.on_construct<BoxColliderComponent>().connect<&rebuildFixtureLater>(*m_physics);
+    m_registry.on_update<BoxColliderComponent>().connect<&rebuildFixtureLater>(*m_physics);
+    m_registry.on_destroy<BoxColliderComponent>().connect<&rebuildFixtureLater>(*m_physics);
+
+    m_registry.on_construct<WorldTransformComponent>().connect<&updateSprite<WorldTransformComponent>>(*m_sprites);
+    m_registry.on_update<WorldTransformComponent>().connect<&updateSprite<WorldTransformComponent>>(*m_sprites);
+    m_registry.on_destroy<WorldTransformComponent>().connect<&removeSprite>(*m_sprites);
+
+    m_registry.on_construct<SpriteComponent>().connect<&updateSprite<SpriteComponent>>(*m_sprites);
+    m_registry.on_update<SpriteComponent>().connect<&updateSprite<SpriteComponent>>(*m_sprites);
+    m_registry.on_destroy<SpriteComponent>().connect<&removeSprite>(*m_sprites);
+
+    // Created up front, so they're maintained as components come and go instead of sorting the pools later on
+    static_cast<void>(sprites());
+    static_cast<void>(rigidbodies());
+
+    m_root = m_registry.create();
+    m_registry.emplace<HierarchyComponent>(m_root);
+}
+
+Scene::Scene(Scene &&other) noexcept {
+    m_registry = std::move(other.m_registry);
+    m_root = other.m_root;
+
+    m_physicsWorld = std::move(other.m_physicsWorld);
+    m_physicsThread = std::move(other.m_physicsThread);
+    m_physicsStep = std::move(other.m_physicsStep);
+
+    m_interpolationAlpha = other.m_interpolationAlpha;
+
+    m_index = std::move(other.m_index);
+    m_transforms = std::move(other.m_transforms);
+    m_physics = std::move(other.m_physics);
+    m_sprites = std::move(other.m_sprites);
+}
 
-        rigidbody.fixture = static_cast<void *>(fixture);
+Scene &Scene::operator=(Scene &&other) noexcept {
+    waitForPhysicsStep();
+
+    m_registry = std::move(other.m_registry);
+    m_root = other.m_root;
+
+    m_physicsWorld = std::move(other.m_physicsWorld);
+    m_physicsThread = std::move(other.m_physicsThread);
+    m_physicsStep = std::move(other.m_physicsStep);
+
+    m_interpolationAlpha = other.m_interpolationAlpha;
+
+    m_index = std::move(other.m_index);
+    m_transforms = std::move(other.m_transforms);
+    m_physics = std::move(other.m_physics);
+    m_sprites = std::move(other.m_sprites);
+
+    return *this;
+}
+
+Scene Scene::copy(Scene &source) {
+    Scene copiedScene;
+
+    // Identity mapping, every entity (the root included) is recreated with the same identifier.
+    copiedScene.m_registry.destroy(copiedScene.m_root);
+
+    for (auto entity : source.m_registry.view<HierarchyComponent>()) {
+        copiedScene.m_registry.create(entity);
     }
+
+    copiedScene.m_root = source.m_root;
+
+    copyComponents<IdComponent>(source.m_registry, copiedScene.m_registry);
+    copyComponents<HierarchyComponent>(source.m_registry, copiedScene.m_registry);
+    copyComponents<TransformComponent>(source.m_registry, copiedScene.m_registry);
+    copyComponents<WorldTransformComponent>(source.m_registry, copiedScene.m_registry);
+    copyComponents<SpriteComponent>(source.m_registry, copiedScene.m_registry);
+    copyComponents<RigidbodyComponent>(source.m_registry, copiedScene.m_registry);
+    copyComponents<BoxColliderComponent>(source.m_registry, copiedScene.m_registry);
+    copyComponents<ScriptComponent>(source.m_registry, copiedScene.m_registry);
+
+    // World transforms were copied along, only what's still outdated in the source has to be updated.
+    copiedScene.m_transforms->dirty = source.m_transforms->dirty;
+
+    copiedScene.setPhysicsThreaded(source.isPhysicsThreaded());
+
+    return copiedScene;
+}
+
+void Scene::start() {
+    m_physicsWorld = std::unique_ptr<b2World>(new b2World({ 0.0f, -10.0f }));
+
+    // Bodies live in world space
+    updateWorldTransforms();
+
+    for (auto [entity, rigidbody, transform] : rigidbodies().each()) {
+        createBody(entity, rigidbody, transform);
+    }
+
+    // Bodies were just created where their entities are
+    m_physics->movedBodies.clear();
+
+    m_physics->isSimulating = true;
 }
 
 void Scene::stop() {
+    waitForPhysicsStep();
+
+    m_physics->isSimulating = false;
+    m_physics->bodyStates.clear();
+    m_physics->hasStepResults = false;
+    m_physics->awakeBodies.clear();
+    m_physics->bodiesToDestroy.clear();
+    m_physics->bodiesToCreate.clear();
+    m_physics->bodiesToUpdate.clear();
+    m_physics->fixturesToRebuild.clear();
+
     m_physicsWorld.reset();
 }
 
-void Scene::onUpdate(float deltaTime) {
+void Scene::onFixedUpdate(float stepDuration) {
     // The suggested iteration count for Box2D is 8 for velocity and 3 for position.
     // You can tune this number to your liking,
     // just keep in mind that this has a trade-off between performance and accuracy.
     // ~ https://box2d.org/documentation/md__d_1__git_hub_box2d_docs_hello.html#autotoc_md24
-    constexpr int32_t velocityIterations = 8;
-    constexpr int32_t positionIterations = 3;
+    static constexpr int32_t velocityIterations = 8;
+    static constexpr int32_t positionIterations = 3;
 
-    auto view = m_registry.view<TransformComponent, RigidbodyComponent>();
+    waitForPhysicsStep();
 
-    for (auto entity : view) {
-        auto [transform, rigidbody] = view.get<TransformComponent, RigidbodyComponent>(entity);
+    // Picks up transforms changed by scripts or the editor, marking their bodies as moved
+    updateWorldTransforms();
 
-        auto *body = static_cast<b2Body *>(rigidbody.body);
+    // Left by a step on the physics thread
+    writeBackBodyStates();
 
-        const auto &position = body->GetPosition();
-        const auto angle = body->GetAngle();
+    updateBodies();
 
-        if (transform.position.x != position.x || transform.position.y != position.y || transform.rotation != angle) {
-            body->SetTransform({ transform.position.x, transform.position.y }, transform.rotation);
+    for (auto entity : m_physics->movedBodies) {
+        auto *body = static_cast<b2Body *>(m_registry.get<RigidbodyComponent>(entity).body);
+        const auto *transform = m_registry.try_get<WorldTransformComponent>(entity);
+
+        // Without a world transform to create it at there is no body, or the transform was removed since
+        if (body == nullptr || transform == nullptr)
+            continue;
+
+        body->SetTransform({ transform->position.x, transform->position.y }, transform->rotation);
+        body->SetAwake(true);
+
+        // Teleported, drawn where it was moved to rather than blended there. Static bodies are never blended.
+        if (body->GetType() == b2BodyType::b2_staticBody) {
+            m_registry.remove<PreviousWorldTransformComponent>(entity);
+        } else {
+            m_registry.emplace_or_replace<PreviousWorldTransformComponent>(
+                entity, transform->position, transform->rotation
+            );
         }
     }
 
-    m_physicsWorld->Step(deltaTime, velocityIterations, positionIterations);
+    m_physics->movedBodies.clear();
 
-    for (auto entity : view) {
-        auto [transform, rigidbody] = view.get<TransformComponent, RigidbodyComponent>(entity);
+    // Only touches the world and the step results, both stay where they are when the scene is moved
+    auto step = [world = m_physicsWorld.get(), physics = m_physics.get(), stepDuration] {
+        auto &bodyStates = physics->bodyStates;
 
-        auto *body = static_cast<b2Body *>(rigidbody.body);
+        world->Step(stepDuration, velocityIterations, positionIterations);
+
+        // Sleeping and static bodies haven't moved
+        for (auto *body = world->GetBodyList(); body != nullptr; body = body->GetNext()) {
+            if (!body->IsAwake() || body->GetType() == b2BodyType::b2_staticBody)
+                continue;
+
+            bodyStates.push_back(BodyState {
+                .entity = static_cast<entt::entity>(body->GetUserData().pointer),
+                .position = body->GetPosition(),
+                .angle = body->GetAngle(),
+            });
+        }
+
+        physics->hasStepResults = true;
+    };
 
-        const auto &position = body->GetPosition();
-        const auto angle = body->GetAngle();
+    if (m_physicsThread != nullptr) {
+        auto task = std::make_shared<std::packaged_task<void()>>(step);
 
-        transform.position.x = position.x;
-        transform.position.y = position.y;
-        transform.rotation = angle;
+        m_physicsStep = task->get_future();
+        m_physicsThread->submit([task] { (*task)(); });
+    } else {
+        step();
+
+        writeBackBodyStates();
     }
 }
 
-Entity &Scene::create() {
-    auto entityId = m_registry.create();
+void Scene::setPhysicsThreaded(bool isThreaded) {
+    if (isThreaded == isPhysicsThreaded())
+        return;
 
-    m_entities.emplace_back(&m_registry, entityId);
+    // The results of a step still running are written back by the next update as usual
+    waitForPhysicsStep();
 
-    return m_entities.back();
+    m_physicsThread = isThreaded ? std::make_unique<ThreadPool>(1) : nullptr;
 }
 
-void Scene::remove(Entity &entity) {
-    auto result = std::find(m_entities.begin(), m_entities.end(), entity);
-
-    if (result != m_entities.end()) {
-        m_entities.erase(result);
+void Scene::updateBodies() {
+    for (auto *body : m_physics->bodiesToDestroy) {
+        m_physicsWorld->DestroyBody(body);
     }
-}
 
-std::optional<Entity *> Scene::getById(UniqueId id) {
-    for (auto &entity : m_entities) {
-        if (entity.id() == id) {
-            return std::make_optional(&entity);
+    m_physics->bodiesToDestroy.clear();
+
+    for (auto entity : m_physics->bodiesToCreate) {
+        if (!m_registry.valid(entity) || !m_registry.all_of<RigidbodyComponent, WorldTransformComponent>(entity))
+            continue;
+
+        auto &rigidbody = m_registry.get<RigidbodyComponent>(entity);
+
+        if (rigidbody.body == nullptr) {
+            createBody(entity, rigidbody, m_registry.get<WorldTransformComponent>(entity));
         }
+
+        // Created where the entity is
+        m_physics->movedBodies.erase(entity);
     }
 
-    for (auto &entity : m_entities) {
-        auto result = getById(entity, id);
+    m_physics->bodiesToCreate.clear();
 
-        if (result.has_value()) {
-            return result;
+    for (auto entity : m_physics->bodiesToUpdate) {
+        if (!m_registry.valid(entity) || !m_registry.all_of<RigidbodyComponent>(entity))
+            continue;
+
+        const auto &rigidbody = m_registry.get<RigidbodyComponent>(entity);
+        auto *body = static_cast<b2Body *>(rigidbody.body);
+        auto *fixture = static_cast<b2Fixture *>(rigidbody.fixture);
+
+        if (body == nullptr)
+            continue;
+
+        auto bodyType = toBodyType(rigidbody.bodyType);
+
+        // Static bodies don't move, they're drawn where they are
+        if (bodyType == b2BodyType::b2_staticBody && body->GetType() != bodyType) {
+            m_registry.remove<PreviousWorldTransformComponent>(entity);
         }
-    }
 
-    return std::nullopt;
-}
+        // Both are no-ops when nothing changed
+        body->SetType(bodyType);
+        body->SetFixedRotation(rigidbody.hasFixedRotation);
 
-std::optional<const Entity *> Scene::getById(UniqueId id) const {
-    for (auto &entity : m_entities) {
-        if (entity.id() == id) {
-            return std::make_optional(&entity);
+        if (fixture == nullptr)
+            continue;
+
+        fixture->SetFriction(rigidbody.friction);
+        fixture->SetRestitution(rigidbody.restitution);
+        fixture->SetRestitutionThreshold(rigidbody.restitutionThreshold);
+
+        if (fixture->GetDensity() != rigidbody.density) {
+            fixture->SetDensity(rigidbody.density);
+
+            body->ResetMassData();
         }
     }
 
-    for (auto &entity : m_entities) {
-        auto result = getById(entity, id);
+    m_physics->bodiesToUpdate.clear();
+
+    for (auto entity : m_physics->fixturesToRebuild) {
+        if (!m_registry.valid(entity) || !m_registry.all_of<RigidbodyComponent, WorldTransformComponent>(entity))
+            continue;
 
-        if (result.has_value()) {
-            return result;
+        auto &rigidbody = m_registry.get<RigidbodyComponent>(entity);
+        auto *body = static_cast<b2Body *>(rigidbody.body);
+
+        if (body == nullptr)
+            continue;
+
+        // Destroying and creating fixtures updates the body's mass
+        if (rigidbody.fixture != nullptr) {
+            body->DestroyFixture(static_cast<b2Fixture *>(rigidbody.fixture));
         }
+
+        rigidbody.fixture = createFixture(entity, body, rigidbody, m_registry.get<WorldTransformComponent>(entity));
     }
 
-    return std::nullopt;
+    m_physics->fixturesToRebuild.clear();
 }
 
-void Scene::forEachEntity(const std::function<void(Entity &)> &callback) {
-    for (auto &entity : m_entities) {
-        callback(entity);
-    }
+void Scene::createBody(entt::entity entity, RigidbodyComponent &rigidbody, const WorldTransformComponent &transform) {
+    b2BodyDef bodyDefinition {};
+    bodyDefinition.userData.pointer = static_cast<uintptr_t>(entity);
+    bodyDefinition.type = toBodyType(rigidbody.bodyType);
+    bodyDefinition.fixedRotation = rigidbody.hasFixedRotation;
+    bodyDefinition.position.Set(transform.position.x, transform.position.y);
+    bodyDefinition.angle = transform.rotation;
 
-    for (auto &entity : m_entities) {
-        forEachChild(entity, callback);
-    }
+    b2Body *body = m_physicsWorld->CreateBody(&bodyDefinition);
+
+    rigidbody.body = static_cast<void *>(body);
+    rigidbody.fixture = static_cast<void *>(createFixture(entity, body, rigidbody, transform));
+
+    // Starts where the entity is, only moving bodies are blended from a previous pose once they've stepped
+    m_registry.remove<PreviousWorldTransformComponent>(entity);
 }
 
-std::optional<Entity *> Scene::getById(Entity &parent, UniqueId id) {
-    for (auto &child : parent.children()) {
-        if (child.id() == id) {
-            return std::make_optional(&child);
+b2Fixture *Scene::createFixture(
+    entt::entity entity, b2Body *body, const RigidbodyComponent &rigidbody, const WorldTransformComponent &transform
+) {
+    const auto *collider = m_registry.try_get<BoxColliderComponent>(entity);
+
+    if (collider == nullptr)
+        return nullptr;
+
+    b2PolygonShape boxShape;
+    boxShape.SetAsBox(transform.scale.x * collider->size.x * 0.5f, transform.scale.y * collider->size.y * 0.5f);
+
+    b2FixtureDef fixtureDefinition {};
+    fixtureDefinition.shape = &boxShape;
+    fixtureDefinition.density = rigidbody.density;
+    fixtureDefinition.friction = rigidbody.friction;
+    fixtureDefinition.restitution = rigidbody.restitution;
+    fixtureDefinition.restitutionThreshold = rigidbody.restitutionThreshold;
+
+    return body->CreateFixture(&fixtureDefinition);
+}
+
+void Scene::updateWorldTransforms() {
+    if (m_transforms->dirty.empty())
+        return;
+
+    // Changed entities without a changed ancestor, updating their subtrees covers every other change
+    std::vector<entt::entity> changedRoots;
+
+    for (auto entity : m_transforms->dirty) {
+        // Removed since
+        if (!m_registry.valid(entity))
+            continue;
+
+        auto parent = m_registry.get<HierarchyComponent>(entity).parent;
+
+        while (parent != entt::null && !m_transforms->dirty.contains(parent)) {
+            parent = m_registry.get<HierarchyComponent>(parent).parent;
+        }
+
+        if (parent == entt::null) {
+            changedRoots.push_back(entity);
         }
     }
 
-    for (auto &child : parent.children()) {
-        auto result = getById(child, id);
+    struct PendingEntity {
+            entt::entity entity;
+            WorldTransformComponent parent;
+    };
+
+    std::vector<PendingEntity> pendingEntities;
+
+    for (auto entity : changedRoots) {
+        pendingEntities.push_back({ entity, parentWorldTransform(entity) });
+    }
+
+    while (!pendingEntities.empty()) {
+        auto [entity, parent] = pendingEntities.back();
+        pendingEntities.pop_back();
+
+        const auto *transform = m_registry.try_get<TransformComponent>(entity);
+
+        // Entities without a transform pass their parent's world transform on to their children.
+        auto worldTransform = parent;
+
+        if (transform != nullptr) {
+            worldTransform = {
+                .matrix = parent.matrix * localMatrix(*transform),
+                .position = glm::vec2(parent.matrix * glm::vec3(transform->position, 1.0f)),
+                .scale = parent.scale * transform->scale,
+                .rotation = parent.rotation + transform->rotation,
+                .parentMatrix = parent.matrix,
+                .parentRotation = parent.rotation,
+            };
 
-        if (result.has_value()) {
-            return result;
+            // Notifies the sprite index
+            m_registry.emplace_or_replace<WorldTransformComponent>(entity, worldTransform);
+        }
+
+        for (auto child : Entity(&m_registry, entity).children()) {
+            pendingEntities.push_back({ child.m_entityId, worldTransform });
         }
     }
 
-    return std::nullopt;
+    m_transforms->dirty.clear();
 }
 
-std::optional<const Entity *> Scene::getById(const Entity &parent, UniqueId id) const {
-    for (auto &child : parent.children()) {
-        if (child.id() == id) {
-            return std::make_optional(&child);
-        }
+Entity Scene::create() {
+    return root().createChild();
+}
+
+void Scene::remove(Entity entity) {
+    if (entity.m_registry != &m_registry || !entity.isValid())
+        return;
+
+    entity.unlink();
+    entity.destroy();
+}
+
+void Scene::querySprites(const BoundingBox &bounds, std::vector<entt::entity> &result) const {
+    m_sprites->index.query(bounds, [&](entt::entity entity) { result.push_back(entity); });
+}
+
+size_t Scene::queryOverlaps(
+    std::span<const BoundingBox> queries, std::span<UniqueId> results, std::span<uint32_t> resultCounts
+) {
+    if (resultCounts.size() < queries.size()) {
+        throw std::invalid_argument("Fewer result counts than queries");
     }
 
-    for (auto &child : parent.children()) {
-        auto result = getById(child, id);
+    waitForPhysicsStep();
 
-        if (result.has_value()) {
-            return result;
-        }
+    size_t resultCount = 0;
+
+    b2Transform identity;
+    identity.SetIdentity();
+
+    for (size_t index = 0; index < queries.size(); index++) {
+        resultCounts[index] = 0;
+
+        if (m_physicsWorld == nullptr)
+            continue;
+
+        const auto &bounds = queries[index];
+
+        auto center = (bounds.min + bounds.max) * 0.5f;
+        auto halfExtents = (bounds.max - bounds.min) * 0.5f;
+
+        b2PolygonShape box;
+        box.SetAsBox(halfExtents.x, halfExtents.y, b2Vec2(center.x, center.y), 0.0f);
+
+        b2AABB area;
+        area.lowerBound.Set(bounds.min.x, bounds.min.y);
+        area.upperBound.Set(bounds.max.x, bounds.max.y);
+
+        // The broadphase reports every fixture whose (enlarged) bounds overlap, the shapes are tested exactly.
+        // Every body has a single fixture, so no entity is reported twice.
+        FixtureQuery query([&](b2Fixture *fixture) {
+            if (resultCount == results.size())
+                return false;
+
+            const auto *id = idOfFixture(m_registry, fixture);
+
+            if (id == nullptr)
+                return true;
+
+            if (!b2TestOverlap(fixture->GetShape(), 0, &box, 0, fixture->GetBody()->GetTransform(), identity))
+                return true;
+
+            results[resultCount++] = id->id;
+            resultCounts[index] += 1;
+
+            return true;
+        });
+
+        m_physicsWorld->QueryAABB(&query, area);
     }
 
-    return std::nullopt;
+    return resultCount;
 }
 
-void Scene::forEachChild(Entity &parent, const std::function<void(Entity &)> &callback) {
-    for (auto &entity : parent.children()) {
-        callback(entity);
+void Scene::raycast(std::span<const RaycastQuery> queries, std::span<QueryHit> hits) {
+    if (hits.size() < queries.size()) {
+        throw std::invalid_argument("Fewer hits than queries");
     }
 
-    for (auto &entity : parent.children()) {
-        forEachChild(entity, callback);
+    waitForPhysicsStep();
+
+    for (size_t index = 0; index < queries.size(); index++) {
+        auto &hit = hits[index];
+        const auto &ray = queries[index];
+
+        hit = QueryHit {};
+
+        // Box2D doesn't accept zero length rays
+        if (m_physicsWorld == nullptr || ray.from == ray.to)
+            continue;
+
+        // Clipping the ray to every hit reported leaves the closest one last
+        FixtureRaycast raycast([&](b2Fixture *fixture, const b2Vec2 &point, const b2Vec2 &normal, float fraction) {
+            const auto *id = idOfFixture(m_registry, fixture);
+
+            if (id == nullptr)
+                return -1.0f;
+
+            hit = QueryHit {
+                .id = id->id,
+                .point = glm::vec2(point.x, point.y),
+                .normal = glm::vec2(normal.x, normal.y),
+                .fraction = fraction,
+                .isHit = 1,
+            };
+
+            return fraction;
+        });
+
+        m_physicsWorld->RayCast(&raycast, b2Vec2(ray.from.x, ray.from.y), b2Vec2(ray.to.x, ray.to.y));
     }
 }
 
-void Scene::copyEntity(Entity &target, Entity &source) {
-    target.m_id = source.m_id;
+void Scene::boxCast(std::span<const BoxCastQuery> queries, std::span<QueryHit> hits) {
+    if (hits.size() < queries.size()) {
+        throw std::invalid_argument("Fewer hits than queries");
+    }
 
-    if (source.hasComponent<TransformComponent>()) {
-        auto &transform = source.getComponent<TransformComponent>();
+    waitForPhysicsStep();
 
-        target.addComponent<TransformComponent>(transform);
-    }
+    for (size_t index = 0; index < queries.size(); index++) {
+        auto &hit = hits[index];
+        const auto &cast = queries[index];
 
-    if (source.hasComponent<SpriteComponent>()) {
-        auto &sprite = source.getComponent<SpriteComponent>();
+        hit = QueryHit {};
 
-        target.addComponent<SpriteComponent>(sprite);
-    }
+        if (m_physicsWorld == nullptr)
+            continue;
+
+        b2PolygonShape box;
+        box.SetAsBox(cast.size.x * 0.5f, cast.size.y * 0.5f);
+
+        b2Transform start(b2Vec2(cast.center.x, cast.center.y), b2Rot(cast.rotation));
+        b2Vec2 translation(cast.translation.x, cast.translation.y);
+
+        // Only fixtures within the area swept by the box can be hit
+        b2AABB startArea;
+        box.ComputeAABB(&startArea, start, 0);
 
-    if (source.hasComponent<RigidbodyComponent>()) {
-        auto &rigidbody = source.getComponent<RigidbodyComponent>();
+        b2AABB area;
+        area.lowerBound = b2Min(startArea.lowerBound, startArea.lowerBound + translation);
+        area.upperBound = b2Max(startArea.upperBound, startArea.upperBound + translation);
 
-        target.addComponent<RigidbodyComponent>(rigidbody);
+        FixtureQuery query([&](b2Fixture *fixture) {
+            const auto *id = idOfFixture(m_registry, fixture);
+
+            if (id == nullptr)
+                return true;
+
+            const auto &fixtureTransform = fixture->GetBody()->GetTransform();
+
+            // Box2D's shape cast reports no hit for shapes overlapping from the start
+            if (b2TestOverlap(fixture->GetShape(), 0, &box, 0, fixtureTransform, start)) {
+                if (hit.isHit == 0 || hit.fraction > 0.0f) {
+                    hit = QueryHit {
+                        .id = id->id,
+                        .point = cast.center,
+                        .normal = glm::vec2(0.0f, 0.0f),
+                        .fraction = 0.0f,
+                        .isHit = 1,
+                    };
+                }
+
+                return true;
+            }
+
+            b2ShapeCastInput input;
+            input.proxyA.Set(fixture->GetShape(), 0);
+            input.proxyB.Set(&box, 0);
+            input.transformA = fixtureTransform;
+            input.transformB = start;
+            input.translationB = translation;
+
+            b2ShapeCastOutput output;
+
+            if (!b2ShapeCast(&output, &input) || (hit.isHit != 0 && output.lambda >= hit.fraction))
+                return true;
+
+            hit = QueryHit {
+                .id = id->id,
+                .point = glm::vec2(output.point.x, output.point.y),
+                .normal = glm::vec2(output.normal.x, output.normal.y),
+                .fraction = output.lambda,
+                .isHit = 1,
+            };
+
+            return true;
+        });
+
+        m_physicsWorld->QueryAABB(&query, area);
     }
+}
 
-    if (source.hasComponent<BoxColliderComponent>()) {
-        auto &collider = source.getComponent<BoxColliderComponent>();
+std::optional<Entity> Scene::getById(UniqueId id) {
+    auto result = m_index->entities.find(id);
+
+    if (result == m_index->entities.end())
+        return std::nullopt;
+
+    return std::make_optional<Entity>(&m_registry, result->second);
+}
 
-        target.addComponent<BoxColliderComponent>(collider);
+std::optional<const Entity> Scene::getById(UniqueId id) const {
+    auto result = m_index->entities.find(id);
+
+    if (result == m_index->entities.end())
+        return std::nullopt;
+
+    return std::make_optional<const Entity>(root().m_registry, result->second);
+}
+
+void Scene::forEachEntity(const std::function<void(Entity &)> &callback) {
+    for (auto entityId : m_registry.view<IdComponent>()) {
+        Entity entity(&m_registry, entityId);
+
+        callback(entity);
     }
+}
+
+WorldTransformComponent Scene::parentWorldTransform(entt::entity entity) const {
+    auto parent = m_registry.get<HierarchyComponent>(entity).parent;
 
-    if (source.hasComponent<ScriptComponent>()) {
-        auto &script = source.getComponent<ScriptComponent>();
+    while (parent != entt::null) {
+        // Up to date, ancestors of changed subtrees haven't changed themselves
+        if (const auto *worldTransform = m_registry.try_get<WorldTransformComponent>(parent))
+            return *worldTransform;
 
-        target.addComponent<ScriptComponent>(script);
+        parent = m_registry.get<HierarchyComponent>(parent).parent;
     }
 
-    for (auto &child : source.children()) {
-        copyEntity(target.createChild(), child);
+    return {};
+}
+
+void Scene::waitForPhysicsStep() {
+    if (m_physicsStep.valid()) {
+        m_physicsStep.get();
     }
 }
 
-void Scene::updateRegistry(Entity &entity, entt::registry *registry) {
-    entity.m_registry = &m_registry;
+void Scene::writeBackBodyStates() {
+    if (!m_physics->hasStepResults)
+        return;
+
+    m_physics->hasStepResults = false;
+    m_physics->isWritingBack = true;
+
+    // Bodies which fell asleep during the step have no results, they're drawn where they came to rest
+    for (auto entity : m_physics->awakeBodies) {
+        const auto *rigidbody = m_registry.valid(entity) ? m_registry.try_get<RigidbodyComponent>(entity) : nullptr;
+
+        if (rigidbody == nullptr || rigidbody->body == nullptr)
+            continue;
 
-    for (auto &child : entity.children()) {
-        child.m_registry = &m_registry;
+        if (!static_cast<b2Body *>(rigidbody->body)->IsAwake()) {
+            m_registry.remove<PreviousWorldTransformComponent>(entity);
+        }
+    }
+
+    m_physics->awakeBodies.clear();
+
+    for (const auto &bodyState : m_physics->bodyStates) {
+        auto entity = bodyState.entity;
+
+        m_physics->awakeBodies.push_back(entity);
+
+        // Moved since the step started, the move wins
+        if (m_physics->movedBodies.contains(entity))
+            continue;
+
+        // Or lost its rigidbody, the body is on its way out
+        if (!m_registry.valid(entity) || !m_registry.all_of<RigidbodyComponent, WorldTransformComponent>(entity))
+            continue;
 
-        updateRegistry(child, registry);
+        const auto &transform = m_registry.get<WorldTransformComponent>(entity);
+        const auto &position = bodyState.position;
+        const auto angle = bodyState.angle;
+
+        // Where the body is drawn from until the next results, so drawing blends between the last two finished steps
+        // whether they ran on the physics thread or not
+        m_registry.emplace_or_replace<PreviousWorldTransformComponent>(entity, transform.position, transform.rotation);
+
+        if (transform.position.x != position.x || transform.position.y != position.y || transform.rotation != angle) {
+            // Back to the parent's space, exact for entities without parents
+            auto localPosition = glm::inverse(transform.parentMatrix) * glm::vec3(position.x, position.y, 1.0f);
+            auto localRotation = angle - transform.parentRotation;
+
+            m_registry.patch<TransformComponent>(entity, [&](auto &patchedTransform) {
+                patchedTransform.position = glm::vec2(localPosition);
+                patchedTransform.rotation = localRotation;
+            });
+        }
     }
+
+    m_physics->bodyStates.clear();
+
+    updateWorldTransforms();
+
+    m_physics->isWritingBack = false;
 }
@@ -11,7 +11,7 @@ Scene SceneSerde::deserialize(const std::string &input) {
     for (size_t entityIndex = 0; entityIndex < entitiesNode.size(); entityIndex++) {
         auto entityNode = entitiesNode[entityIndex];
 
-        auto &entity = scene.create();
+        auto entity = scene.create();
 
         deserializeEntity(entityNode, entity);
     }
@@ -27,7 +27,7 @@ std::string SceneSerde::serialize(const Scene &scene) {
     emitter << YAML::Key << "entities";
     emitter << YAML::BeginSeq;
 
-    for (const auto &entity : scene.entities()) {
+    for (auto entity : scene.entities()) {
         serializeEntity(emitter, entity);
     }
 
@@ -69,7 +69,15 @@ void SceneSerde::deserializeEntity(YAML::Node &entityNode, Entity &entity) {
 
             auto texture = m_assetManager->getTextureById(id);
 
-            entity.addComponent<SpriteComponent>(texture);
+            auto sortingLayerNode = spriteNode["sorting-layer"];
+            auto orderInLayerNode = spriteNode["order-in-layer"];
+            auto isStaticNode = spriteNode["static"];
+
+            auto sortingLayer = sortingLayerNode ? sortingLayerNode.as<int32_t>() : 0;
+            auto orderInLayer = orderInLayerNode ? orderInLayerNode.as<int32_t>() : 0;
+            auto isStatic = isStaticNode ? isStaticNode.as<bool>() : false;
+
+            entity.addComponent<SpriteComponent>(texture, sortingLayer, orderInLayer, isStatic);
         }
 
         auto rigidbodyNode = componentsNode["rigidbody"];
@@ -131,7 +139,7 @@ void SceneSerde::deserializeEntity(YAML::Node &entityNode, Entity &entity) {
 
     if (childrenNode) {
         for (size_t childIndex = 0; childIndex < childrenNode.size(); childIndex++) {
-            auto &childEntity = entity.createChild();
+            auto childEntity = entity.createChild();
             auto childNode = childrenNode[childIndex];
 
             deserializeEntity(childNode, childEntity);
@@ -191,6 +199,15 @@ void SceneSerde::serializeEntity(YAML::Emitter &emitter, const Entity &entity) {
             emitter << YAML::Key << "id";
             emitter << YAML::Value << sprite.texture->id().value();
 
+            emitter << YAML::Key << "sorting-layer";
+            emitter << YAML::Value << sprite.sortingLayer;
+
+            emitter << YAML::Key << "order-in-layer";
+            emitter << YAML::Value << sprite.orderInLayer;
+
+            emitter << YAML::Key << "static";
+            emitter << YAML::Value << sprite.isStatic;
+
             emitter << YAML::EndMap;
         }
 
@@ -285,7 +302,7 @@ void SceneSerde::serializeEntity(YAML::Emitter &emitter, const Entity &entity) {
     emitter << YAML::Key << "children";
     emitter << YAML::BeginSeq;
 
-    for (const auto &child : entity.children()) {
+    for (auto child : entity.children()) {
         serializeEntity(emitter, child);
     }
 
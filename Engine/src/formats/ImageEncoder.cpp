@@ -0,0 +1,13 @@
+#include "delusion/formats/ImageEncoder.hpp"
+
+#include <cimage.h>
+
+bool ImageEncoder::encode(const std::string &path, Image &image) {
+    cimage_image encodedImage = {
+        .width = image.width(),
+        .height = image.height(),
+        .pixels = reinterpret_cast<cimage_rgba8 *>(image.pixels().data()),
+    };
+
+    return cimage_image_encode_to_file(path.c_str(), &encodedImage);
+}
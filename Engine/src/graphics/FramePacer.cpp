@@ -0,0 +1,82 @@
+#include "delusion/graphics/FramePacer.hpp"
+
+#include <algorithm>
+
+#include <wgpu.h>
+
+static float millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+FramePacer::FramePacer(WGPUDevice device, WGPUQueue queue, uint32_t maxFramesInFlight)
+    : m_device(device), m_queue(queue), m_maxFramesInFlight(std::clamp(maxFramesInFlight, 1u, s_maxFramesInFlight)) {
+    for (auto &frame : m_frames) {
+        frame.pacer = this;
+    }
+}
+
+FramePacer::~FramePacer() {
+    // Work done callbacks point into m_frames, so they have to complete first.
+    while (m_framesInFlight > 0) {
+        wgpuDevicePoll(m_device, true, nullptr);
+    }
+}
+
+std::unique_ptr<FramePacer> FramePacer::create(WGPUDevice device, WGPUQueue queue, uint32_t maxFramesInFlight) {
+    return std::unique_ptr<FramePacer>(new FramePacer(device, queue, maxFramesInFlight));
+}
+
+void FramePacer::beginFrame() {
+    auto waitStart = Clock::now();
+
+    // Picks up frames which have already finished without blocking
+    wgpuDevicePoll(m_device, false, nullptr);
+
+    while (m_framesInFlight >= m_maxFramesInFlight) {
+        // Frames are submitted in order, waiting for everything instead would drain the GPU
+        const Frame *oldestFrame = nullptr;
+
+        for (const auto &frame : m_frames) {
+            if (frame.isInFlight && (oldestFrame == nullptr || frame.submissionIndex < oldestFrame->submissionIndex)) {
+                oldestFrame = &frame;
+            }
+        }
+
+        WGPUWrappedSubmissionIndex wrappedSubmissionIndex = {
+            .queue = m_queue,
+            .submissionIndex = oldestFrame->submissionIndex,
+        };
+
+        // Its work done callback runs while polling, freeing the slot
+        wgpuDevicePoll(m_device, true, &wrappedSubmissionIndex);
+    }
+
+    m_statistics.cpuWaitMilliseconds = millisecondsSince(waitStart);
+    m_statistics.framesInFlight = m_framesInFlight;
+}
+
+void FramePacer::endFrame(WGPUSubmissionIndex submissionIndex) {
+    // There's always a free slot, beginFrame() made sure the limit isn't reached
+    auto &frame = *std::find_if(m_frames.begin(), m_frames.end(), [](const Frame &slot) { return !slot.isInFlight; });
+
+    frame.submitTime = Clock::now();
+    frame.submissionIndex = submissionIndex;
+    frame.isInFlight = true;
+
+    m_framesInFlight += 1;
+
+    auto onSubmittedWorkDone = [](WGPUQueueWorkDoneStatus, void *userData) {
+        auto &frame = *static_cast<Frame *>(userData);
+
+        // Only as precise as the device is polled, which happens at least once per frame.
+        frame.pacer->m_statistics.gpuLatencyMilliseconds = millisecondsSince(frame.submitTime);
+
+        frame.isInFlight = false;
+        frame.pacer->m_framesInFlight -= 1;
+    };
+    wgpuQueueOnSubmittedWorkDone(m_queue, onSubmittedWorkDone, &frame);
+}
+
+void FramePacer::setMaxFramesInFlight(uint32_t maxFramesInFlight) {
+    m_maxFramesInFlight = std::clamp(maxFramesInFlight, 1u, s_maxFramesInFlight);
+}
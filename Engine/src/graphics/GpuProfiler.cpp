@@ -0,0 +1,172 @@
+#include "delusion/graphics/GpuProfiler.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+#include <wgpu.h>
+
+GpuProfiler::GpuProfiler(WGPUDevice device, uint32_t maxPassCount, size_t framesInFlight)
+    : m_device(device), m_maxPassCount(maxPassCount) {
+    // Every pass writes a timestamp at its beginning and one at its end.
+    uint32_t queryCount = 2 * maxPassCount;
+    uint64_t timestampsSize = queryCount * sizeof(uint64_t);
+
+    for (size_t frameIndex = 0; frameIndex < framesInFlight; frameIndex++) {
+        WGPUQuerySetDescriptor querySetDescriptor = {
+            .nextInChain = nullptr,
+            .label = "GPU profiler query set",
+            .type = WGPUQueryType_Timestamp,
+            .count = queryCount,
+        };
+        WGPUQuerySet querySet = wgpuDeviceCreateQuerySet(device, &querySetDescriptor);
+
+        WGPUBufferDescriptor resolveBufferDescriptor = {
+            .nextInChain = nullptr,
+            .label = "GPU profiler resolve buffer",
+            .usage = WGPUBufferUsage_QueryResolve | WGPUBufferUsage_CopySrc,
+            .size = timestampsSize,
+            .mappedAtCreation = false,
+        };
+        WGPUBuffer resolveBuffer = wgpuDeviceCreateBuffer(device, &resolveBufferDescriptor);
+
+        WGPUBufferDescriptor readbackBufferDescriptor = {
+            .nextInChain = nullptr,
+            .label = "GPU profiler readback buffer",
+            .usage = WGPUBufferUsage_MapRead | WGPUBufferUsage_CopyDst,
+            .size = timestampsSize,
+            .mappedAtCreation = false,
+        };
+        WGPUBuffer readbackBuffer = wgpuDeviceCreateBuffer(device, &readbackBufferDescriptor);
+
+        m_frames.push_back(std::make_unique<Frame>(Frame {
+            .profiler = this,
+            .querySet = querySet,
+            .resolveBuffer = resolveBuffer,
+            .readbackBuffer = readbackBuffer,
+            .passNames = {},
+        }));
+    }
+}
+
+GpuProfiler::~GpuProfiler() {
+    // Map callbacks of frames still being read back point into m_frames, so they have to complete first.
+    for (auto &frame : m_frames) {
+        while (frame->isReadingBack) {
+            wgpuDevicePoll(m_device, true, nullptr);
+        }
+
+        wgpuBufferRelease(frame->readbackBuffer);
+        wgpuBufferRelease(frame->resolveBuffer);
+        wgpuQuerySetRelease(frame->querySet);
+    }
+}
+
+std::unique_ptr<GpuProfiler> GpuProfiler::create(WGPUDevice device, uint32_t maxPassCount, size_t framesInFlight) {
+    return std::unique_ptr<GpuProfiler>(new GpuProfiler(device, maxPassCount, framesInFlight));
+}
+
+void GpuProfiler::beginFrame() {
+    // Lets finished readbacks run their callbacks
+    wgpuDevicePoll(m_device, false, nullptr);
+
+    if (m_hasFrameBegun) {
+        m_currentFrameIndex = (m_currentFrameIndex + 1) % m_frames.size();
+    }
+
+    m_hasFrameBegun = true;
+
+    auto &frame = *m_frames[m_currentFrameIndex];
+
+    m_isRecording = m_isEnabled && !frame.isReadingBack;
+
+    if (m_isRecording) {
+        frame.passNames.clear();
+    }
+}
+
+std::optional<WGPURenderPassTimestampWrites> GpuProfiler::timestampWrites(const std::string &passName) {
+    auto &frame = *m_frames[m_currentFrameIndex];
+
+    if (!m_isRecording || frame.passNames.size() == m_maxPassCount)
+        return std::nullopt;
+
+    auto passIndex = static_cast<uint32_t>(frame.passNames.size());
+
+    frame.passNames.push_back(passName);
+
+    return WGPURenderPassTimestampWrites {
+        .querySet = frame.querySet,
+        .beginningOfPassWriteIndex = 2 * passIndex,
+        .endOfPassWriteIndex = 2 * passIndex + 1,
+    };
+}
+
+void GpuProfiler::resolve(WGPUCommandEncoder commandEncoder) {
+    auto &frame = *m_frames[m_currentFrameIndex];
+
+    if (!m_isRecording || frame.passNames.empty())
+        return;
+
+    auto queryCount = static_cast<uint32_t>(2 * frame.passNames.size());
+
+    wgpuCommandEncoderResolveQuerySet(commandEncoder, frame.querySet, 0, queryCount, frame.resolveBuffer, 0);
+    wgpuCommandEncoderCopyBufferToBuffer(
+        commandEncoder, frame.resolveBuffer, 0, frame.readbackBuffer, 0, queryCount * sizeof(uint64_t)
+    );
+}
+
+void GpuProfiler::endFrame() {
+    auto &frame = *m_frames[m_currentFrameIndex];
+
+    if (!m_isRecording || frame.passNames.empty())
+        return;
+
+    frame.isReadingBack = true;
+
+    auto onMapped = [](WGPUBufferMapAsyncStatus status, void *userData) {
+        auto &frame = *static_cast<Frame *>(userData);
+
+        frame.isReadingBack = false;
+
+        if (status != WGPUBufferMapAsyncStatus_Success)
+            return;
+
+        auto timestampsSize = 2 * frame.passNames.size() * sizeof(uint64_t);
+
+        std::vector<uint64_t> timestamps(2 * frame.passNames.size());
+        std::memcpy(
+            timestamps.data(), wgpuBufferGetConstMappedRange(frame.readbackBuffer, 0, timestampsSize), timestampsSize
+        );
+
+        wgpuBufferUnmap(frame.readbackBuffer);
+
+        // Profiling was turned off while the frame was read back
+        if (!frame.profiler->m_isEnabled)
+            return;
+
+        auto &timings = frame.profiler->m_timings;
+
+        timings.clear();
+
+        for (size_t passIndex = 0; passIndex < frame.passNames.size(); passIndex++) {
+            uint64_t beginning = timestamps[2 * passIndex];
+            uint64_t end = timestamps[2 * passIndex + 1];
+
+            // Timestamps are in nanoseconds, but aren't guaranteed to be monotonic
+            double milliseconds = end > beginning ? static_cast<double>(end - beginning) / 1'000'000.0 : 0.0;
+
+            timings.push_back(GpuPassTiming { .name = frame.passNames[passIndex], .milliseconds = milliseconds });
+        }
+    };
+    wgpuBufferMapAsync(
+        frame.readbackBuffer, WGPUMapMode_Read, 0, 2 * frame.passNames.size() * sizeof(uint64_t), onMapped, &frame
+    );
+}
+
+void GpuProfiler::setEnabled(bool isEnabled) {
+    m_isEnabled = isEnabled;
+
+    if (!isEnabled) {
+        m_timings.clear();
+    }
+}
@@ -1,5 +1,7 @@
 #include "delusion/graphics/GraphicsBackend.hpp"
 
+#include <vector>
+
 GraphicsBackend::GraphicsBackend() {
     WGPUInstanceDescriptor descriptor = { .nextInChain = nullptr };
 
@@ -7,6 +9,8 @@ GraphicsBackend::GraphicsBackend() {
 }
 
 GraphicsBackend::~GraphicsBackend() {
+    m_framePacer.reset();
+
     if (m_queue != nullptr) {
         wgpuQueueRelease(m_queue);
     }
@@ -38,10 +42,56 @@ void GraphicsBackend::setup(const Window *window) {
 
     m_adapter = requestAdapter(m_instance, &adapterOptions);
 
+    createDevice();
+
+    wgpuSurfaceGetCapabilities(m_surface, m_adapter, &m_surfaceCapabilities);
+
+    assert(m_surfaceCapabilities.alphaModeCount > 0);
+    assert(m_surfaceCapabilities.formatCount > 0);
+
+    m_preferredFormat = wgpuSurfaceGetPreferredFormat(m_surface, m_adapter);
+}
+
+void GraphicsBackend::setupHeadless(bool preferFallbackAdapter) {
+    WGPURequestAdapterOptions adapterOptions = {
+        .nextInChain = nullptr,
+        .compatibleSurface = nullptr,
+        .powerPreference = WGPUPowerPreference_Undefined,
+        .backendType = WGPUBackendType_Undefined,
+        .forceFallbackAdapter = preferFallbackAdapter,
+    };
+
+    m_adapter = requestAdapter(m_instance, &adapterOptions);
+
+    // Not every machine has a software adapter, any adapter still renders offscreen
+    if (m_adapter == nullptr && preferFallbackAdapter) {
+        adapterOptions.forceFallbackAdapter = false;
+
+        m_adapter = requestAdapter(m_instance, &adapterOptions);
+    }
+
+    assert(m_adapter != nullptr);
+
+    createDevice();
+
+    m_preferredFormat = WGPUTextureFormat_RGBA8Unorm;
+}
+
+void GraphicsBackend::createDevice() {
+    // Optional, only used for profiling
+    std::vector<WGPUFeatureName> requiredFeatures;
+
+    m_hasTimestampQueries = wgpuAdapterHasFeature(m_adapter, WGPUFeatureName_TimestampQuery);
+
+    if (m_hasTimestampQueries) {
+        requiredFeatures.push_back(WGPUFeatureName_TimestampQuery);
+    }
+
     WGPUDeviceDescriptor deviceDescriptor = {
         .nextInChain = nullptr,
         .label = "Device",
-        .requiredFeatureCount = 0,
+        .requiredFeatureCount = requiredFeatures.size(),
+        .requiredFeatures = requiredFeatures.data(),
         .requiredLimits = nullptr,
         .defaultQueue =
             WGPUQueueDescriptor {
@@ -67,12 +117,7 @@ void GraphicsBackend::setup(const Window *window) {
     };
     wgpuQueueOnSubmittedWorkDone(m_queue, onQueueWorkDone, nullptr);
 
-    wgpuSurfaceGetCapabilities(m_surface, m_adapter, &m_surfaceCapabilities);
-
-    assert(m_surfaceCapabilities.alphaModeCount > 0);
-    assert(m_surfaceCapabilities.formatCount > 0);
-
-    m_preferredFormat = wgpuSurfaceGetPreferredFormat(m_surface, m_adapter);
+    m_framePacer = FramePacer::create(m_device, m_queue);
 }
 
 void GraphicsBackend::configureSurface(uint32_t width, uint32_t height) {
@@ -86,10 +131,31 @@ void GraphicsBackend::configureSurface(uint32_t width, uint32_t height) {
         .alphaMode = m_surfaceCapabilities.alphaModes[0],
         .width = width,
         .height = height,
-        .presentMode = WGPUPresentMode_Fifo,
+        .presentMode = m_presentMode,
     };
 
     wgpuSurfaceConfigure(m_surface, &surfaceConfiguration);
+
+    m_surfaceWidth = width;
+    m_surfaceHeight = height;
+}
+
+void GraphicsBackend::setPresentMode(WGPUPresentMode presentMode) {
+    m_presentMode = isPresentModeSupported(presentMode) ? presentMode : WGPUPresentMode_Fifo;
+
+    if (m_surfaceWidth > 0 && m_surfaceHeight > 0) {
+        configureSurface(m_surfaceWidth, m_surfaceHeight);
+    }
+}
+
+bool GraphicsBackend::isPresentModeSupported(WGPUPresentMode presentMode) const {
+    for (size_t index = 0; index < m_surfaceCapabilities.presentModeCount; index++) {
+        if (m_surfaceCapabilities.presentModes[index] == presentMode) {
+            return true;
+        }
+    }
+
+    return false;
 }
 
 WGPUAdapter GraphicsBackend::requestAdapter(WGPUInstance instance, const WGPURequestAdapterOptions *options) {
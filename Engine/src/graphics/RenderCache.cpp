@@ -0,0 +1,219 @@
+#include "delusion/graphics/RenderCache.hpp"
+
+#include <array>
+
+#include "delusion/graphics/Texture2D.hpp"
+
+RenderCache::~RenderCache() {
+    Texture2D::removeDestroyListener(m_destroyListenerHandle);
+
+    for (auto &[textureView, bindGroup] : m_textureBindGroups) {
+        wgpuBindGroupRelease(bindGroup);
+    }
+
+    for (auto &[renderState, pipeline] : m_pipelines) {
+        wgpuRenderPipelineRelease(pipeline);
+    }
+
+    wgpuSamplerRelease(m_sampler);
+    wgpuPipelineLayoutRelease(m_pipelineLayout);
+    wgpuBindGroupLayoutRelease(m_textureBindGroupLayout);
+    wgpuBindGroupLayoutRelease(m_cameraBindGroupLayout);
+}
+
+std::unique_ptr<RenderCache> RenderCache::create(
+    WGPUDevice device, WGPUShaderModule shaderModule, std::vector<WGPUVertexBufferLayout> vertexBufferLayouts,
+    uint64_t cameraUniformSize
+) {
+    WGPUBindGroupLayoutEntry cameraBindGroupLayoutEntry = {
+        .nextInChain = nullptr,
+        .binding = 0,
+        .visibility = WGPUShaderStage_Vertex,
+        .buffer =
+            WGPUBufferBindingLayout {
+                .type = WGPUBufferBindingType_Uniform,
+                .hasDynamicOffset = true,
+                .minBindingSize = cameraUniformSize,
+            },
+    };
+    WGPUBindGroupLayoutDescriptor cameraBindGroupLayoutDescriptor = {
+        .nextInChain = nullptr,
+        .label = "Camera bind group layout",
+        .entryCount = 1,
+        .entries = &cameraBindGroupLayoutEntry,
+    };
+    WGPUBindGroupLayout cameraBindGroupLayout =
+        wgpuDeviceCreateBindGroupLayout(device, &cameraBindGroupLayoutDescriptor);
+
+    std::array<WGPUBindGroupLayoutEntry, 2> textureBindGroupLayoutEntries = {
+        WGPUBindGroupLayoutEntry {
+            .nextInChain = nullptr,
+            .binding = 0,
+            .visibility = WGPUShaderStage_Fragment,
+            .texture =
+                WGPUTextureBindingLayout {
+                    .nextInChain = nullptr,
+                    .sampleType = WGPUTextureSampleType_Float,
+                    .viewDimension = WGPUTextureViewDimension_2DArray,
+                    .multisampled = false,
+                },
+        },
+        WGPUBindGroupLayoutEntry {
+            .binding = 1,
+            .visibility = WGPUShaderStage_Fragment,
+            .sampler =
+                WGPUSamplerBindingLayout {
+                    .type = WGPUSamplerBindingType_Filtering,
+                },
+        },
+    };
+    WGPUBindGroupLayoutDescriptor textureBindGroupLayoutDescriptor = {
+        .nextInChain = nullptr,
+        .label = "Texture bind group layout",
+        .entryCount = textureBindGroupLayoutEntries.size(),
+        .entries = textureBindGroupLayoutEntries.data(),
+    };
+    WGPUBindGroupLayout textureBindGroupLayout =
+        wgpuDeviceCreateBindGroupLayout(device, &textureBindGroupLayoutDescriptor);
+
+    std::array<WGPUBindGroupLayout, 2> bindGroupLayouts = { cameraBindGroupLayout, textureBindGroupLayout };
+
+    WGPUPipelineLayoutDescriptor pipelineLayoutDescriptor = {
+        .nextInChain = nullptr,
+        .label = "Pipeline layout",
+        .bindGroupLayoutCount = bindGroupLayouts.size(),
+        .bindGroupLayouts = bindGroupLayouts.data(),
+    };
+    WGPUPipelineLayout pipelineLayout = wgpuDeviceCreatePipelineLayout(device, &pipelineLayoutDescriptor);
+
+    WGPUSamplerDescriptor samplerDescriptor = {
+        .addressModeU = WGPUAddressMode_ClampToEdge,
+        .addressModeV = WGPUAddressMode_ClampToEdge,
+        .addressModeW = WGPUAddressMode_ClampToEdge,
+        .magFilter = WGPUFilterMode_Linear,
+        .minFilter = WGPUFilterMode_Linear,
+        .mipmapFilter = WGPUMipmapFilterMode_Linear,
+        .lodMinClamp = 0.0f,
+        // No clamping, textures expose their whole mip chain
+        .lodMaxClamp = 32.0f,
+        .compare = WGPUCompareFunction_Undefined,
+        .maxAnisotropy = 1,
+    };
+    WGPUSampler sampler = wgpuDeviceCreateSampler(device, &samplerDescriptor);
+
+    auto renderCache = std::unique_ptr<RenderCache>(new RenderCache(
+        device, shaderModule, std::move(vertexBufferLayouts), cameraBindGroupLayout, textureBindGroupLayout,
+        pipelineLayout, sampler
+    ));
+
+    renderCache->m_destroyListenerHandle = Texture2D::addDestroyListener(
+        [cache = renderCache.get()](Texture2D &texture) { cache->evict(texture.arrayView()); }
+    );
+
+    return renderCache;
+}
+
+WGPURenderPipeline RenderCache::pipeline(const RenderState &renderState) {
+    auto result = m_pipelines.find(renderState);
+
+    if (result != m_pipelines.end()) {
+        return result->second;
+    }
+
+    WGPUVertexState vertexState = {
+        .module = m_shaderModule,
+        .entryPoint = "vs_main",
+        .bufferCount = m_vertexBufferLayouts.size(),
+        .buffers = m_vertexBufferLayouts.data(),
+    };
+
+    WGPUBlendState blendState = { .color =
+                                      WGPUBlendComponent {
+                                          .operation = WGPUBlendOperation_Add,
+                                          .srcFactor = WGPUBlendFactor_SrcAlpha,
+                                          .dstFactor = WGPUBlendFactor_OneMinusSrcAlpha,
+                                      },
+                                  .alpha = WGPUBlendComponent {
+                                      .operation = WGPUBlendOperation_Add,
+                                      .srcFactor = WGPUBlendFactor_Zero,
+                                      .dstFactor = WGPUBlendFactor_One,
+                                  } };
+    WGPUColorTargetState targets[] = {
+        WGPUColorTargetState {
+            .format = renderState.colorFormat,
+            .blend = renderState.blendMode == BlendMode::Alpha ? &blendState : nullptr,
+            .writeMask = WGPUColorWriteMask_All,
+        },
+    };
+    WGPUFragmentState fragmentState = {
+        .module = m_shaderModule,
+        .entryPoint = "fs_main",
+        .targetCount = 1,
+        .targets = targets,
+    };
+
+    WGPURenderPipelineDescriptor renderPipelineDescriptor = {
+        .label = "Render pipeline",
+        .layout = m_pipelineLayout,
+        .vertex = vertexState,
+        .primitive =
+            WGPUPrimitiveState {
+                .topology = WGPUPrimitiveTopology_TriangleList,
+            },
+        .multisample =
+            WGPUMultisampleState {
+                .count = 1,
+                .mask = 0xFFFFFFFF,
+            },
+        .fragment = &fragmentState,
+    };
+    WGPURenderPipeline renderPipeline = wgpuDeviceCreateRenderPipeline(m_device, &renderPipelineDescriptor);
+
+    m_pipelines.emplace(renderState, renderPipeline);
+    m_createdObjectCount += 1;
+
+    return renderPipeline;
+}
+
+WGPUBindGroup RenderCache::textureBindGroup(WGPUTextureView textureView) {
+    auto result = m_textureBindGroups.find(textureView);
+
+    if (result != m_textureBindGroups.end()) {
+        return result->second;
+    }
+
+    std::array<WGPUBindGroupEntry, 2> bindGroupEntries = {
+        WGPUBindGroupEntry {
+            .nextInChain = nullptr,
+            .binding = 0,
+            .textureView = textureView,
+        },
+        WGPUBindGroupEntry {
+            .nextInChain = nullptr,
+            .binding = 1,
+            .sampler = m_sampler,
+        },
+    };
+    WGPUBindGroupDescriptor bindGroupDescriptor = {
+        .nextInChain = nullptr,
+        .layout = m_textureBindGroupLayout,
+        .entryCount = bindGroupEntries.size(),
+        .entries = bindGroupEntries.data(),
+    };
+    WGPUBindGroup bindGroup = wgpuDeviceCreateBindGroup(m_device, &bindGroupDescriptor);
+
+    m_textureBindGroups.emplace(textureView, bindGroup);
+    m_createdObjectCount += 1;
+
+    return bindGroup;
+}
+
+void RenderCache::evict(WGPUTextureView textureView) {
+    auto result = m_textureBindGroups.find(textureView);
+
+    if (result != m_textureBindGroups.end()) {
+        wgpuBindGroupRelease(result->second);
+
+        m_textureBindGroups.erase(result);
+    }
+}
@@ -1,266 +1,826 @@
 #include "delusion/graphics/Renderer.hpp"
 
+#include <algorithm>
 #include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
-#include <glm/ext/matrix_transform.hpp>
 #include <glm/glm.hpp>
 
+#include "delusion/collections/RadixSort.hpp"
+
+// Per-frame data, bound once per pass as group 0. Sprites only reference it, nothing camera related is per instance.
 struct Uniforms {
-        glm::mat4 transformMatrix;
         glm::mat4 viewProjectionMatrix;
 };
 
 static_assert(sizeof(Uniforms) % 16 == 0);
 
-Renderer Renderer::create(WGPUDevice device, WGPUQueue queue, WGPUSurfaceCapabilities surfaceCapabilities) {
-    auto shader = Shader::createFromFile(device, "src/shader.wgsl");
+// Compact per-sprite data, the quad itself is generated in the vertex shader from the vertex index.
+struct SpriteInstance {
+        glm::vec2 position;
+        glm::vec2 scale;
+        float rotation;
+        uint32_t layer;
+
+        // Offset and size in UV space, normalized to 16 bits.
+        std::array<uint16_t, 4> uvRect;
+};
+
+static_assert(sizeof(SpriteInstance) == 32);
+
+struct SpriteBatch {
+        WGPUTextureView textureView;
+
+        uint32_t firstInstance;
+        uint32_t instanceCount;
+};
+
+struct SpriteDraw {
+        WGPUBindGroup textureBindGroup;
+
+        uint32_t firstInstance;
+        uint32_t instanceCount;
+};
+
+// State shared by every draw of a frame.
+struct SpriteBindings {
+        WGPURenderPipeline pipeline;
+
+        WGPUBindGroup cameraBindGroup;
+        uint32_t cameraUniformOffset;
+
+        WGPUBuffer instanceBuffer;
+        uint64_t instanceOffset;
+        uint64_t instanceSize;
+};
+
+// Below this many sprites per render bundle, encoding on worker threads costs more than it saves.
+static constexpr uint32_t s_spritesPerBundle = 4096;
+
+// World space size of the grid cells static sprites are bucketed by, each bucket is culled as a whole.
+static constexpr float s_staticBucketSize = 32.0f;
+
+struct DrawItem {
+        uint64_t key;
+        uint32_t instanceIndex;
+};
+
+// Sorting by the key orders sprites back to front by sorting layer, then order in layer, and groups everything else
+// by pipeline and texture so consecutive sprites can share a draw call.
+// From the most significant bits: sorting layer (8), order in layer (16), pipeline (8), texture (32).
+static uint64_t drawKey(int32_t sortingLayer, int32_t orderInLayer, BlendMode blendMode, WGPUTextureView textureView) {
+    auto layerBits = static_cast<uint64_t>(std::clamp(sortingLayer, INT8_MIN, INT8_MAX) - INT8_MIN);
+    auto orderBits = static_cast<uint64_t>(std::clamp(orderInLayer, INT16_MIN, INT16_MAX) - INT16_MIN);
+    auto pipelineBits = static_cast<uint64_t>(blendMode) & 0xFF;
+
+    // Only has to tell textures apart, views that happen to share these bits are still split into separate batches
+    auto textureBits = static_cast<uint64_t>(static_cast<uint32_t>(reinterpret_cast<uintptr_t>(textureView) >> 4));
+
+    return (layerBits << 56) | (orderBits << 40) | (pipelineBits << 32) | textureBits;
+}
+
+// Sorting layer and order in layer of a draw key, sprites with the same draw order may be drawn in any order.
+static uint32_t drawOrder(uint64_t key) {
+    return static_cast<uint32_t>(key >> 40);
+}
+
+static const std::array<WGPUVertexAttribute, 5> s_instanceAttributes = {
+    WGPUVertexAttribute {
+        .format = WGPUVertexFormat_Float32x2,
+        .offset = offsetof(SpriteInstance, position),
+        .shaderLocation = 0,
+    },
+    WGPUVertexAttribute {
+        .format = WGPUVertexFormat_Float32x2,
+        .offset = offsetof(SpriteInstance, scale),
+        .shaderLocation = 1,
+    },
+    WGPUVertexAttribute {
+        .format = WGPUVertexFormat_Float32,
+        .offset = offsetof(SpriteInstance, rotation),
+        .shaderLocation = 2,
+    },
+    WGPUVertexAttribute {
+        .format = WGPUVertexFormat_Uint32,
+        .offset = offsetof(SpriteInstance, layer),
+        .shaderLocation = 3,
+    },
+    WGPUVertexAttribute {
+        .format = WGPUVertexFormat_Unorm16x4,
+        .offset = offsetof(SpriteInstance, uvRect),
+        .shaderLocation = 4,
+    },
+};
+
+static void encodeDraws(
+    WGPURenderPassEncoder renderPassEncoder, const SpriteBindings &bindings, std::span<const SpriteDraw> draws
+) {
+    wgpuRenderPassEncoderSetPipeline(renderPassEncoder, bindings.pipeline);
+    wgpuRenderPassEncoderSetBindGroup(renderPassEncoder, 0, bindings.cameraBindGroup, 1, &bindings.cameraUniformOffset);
+    wgpuRenderPassEncoderSetVertexBuffer(
+        renderPassEncoder, 0, bindings.instanceBuffer, bindings.instanceOffset, bindings.instanceSize
+    );
+
+    for (const auto &draw : draws) {
+        wgpuRenderPassEncoderSetBindGroup(renderPassEncoder, 1, draw.textureBindGroup, 0, nullptr);
+        wgpuRenderPassEncoderDraw(renderPassEncoder, 6, draw.instanceCount, 0, draw.firstInstance);
+    }
+}
+
+// Splits the draws at the given ascending instance indices into one run before every index and one after the last,
+// draws crossing an index are split in two.
+static std::vector<std::vector<SpriteDraw>> splitDraws(
+    std::span<const SpriteDraw> draws, std::span<const uint32_t> instanceIndices
+) {
+    std::vector<std::vector<SpriteDraw>> runs(instanceIndices.size() + 1);
+
+    size_t runIndex = 0;
+
+    for (auto draw : draws) {
+        while (draw.instanceCount > 0) {
+            while (runIndex < instanceIndices.size() && instanceIndices[runIndex] <= draw.firstInstance) {
+                runIndex += 1;
+            }
+
+            uint32_t instanceCount = draw.instanceCount;
+
+            if (runIndex < instanceIndices.size()) {
+                instanceCount = std::min(instanceCount, instanceIndices[runIndex] - draw.firstInstance);
+            }
+
+            runs[runIndex].push_back(SpriteDraw {
+                .textureBindGroup = draw.textureBindGroup,
+                .firstInstance = draw.firstInstance,
+                .instanceCount = instanceCount,
+            });
+
+            draw.firstInstance += instanceCount;
+            draw.instanceCount -= instanceCount;
+        }
+    }
+
+    return runs;
+}
+
+// Splits the draws into chunks of similar size, draws crossing a chunk boundary are split into two.
+static std::vector<std::vector<SpriteDraw>> chunkDraws(std::span<const SpriteDraw> draws) {
+    std::vector<std::vector<SpriteDraw>> chunks(1);
+    uint32_t chunkSpriteCount = 0;
+
+    for (auto draw : draws) {
+        while (draw.instanceCount > 0) {
+            if (chunkSpriteCount == s_spritesPerBundle) {
+                chunks.emplace_back();
+                chunkSpriteCount = 0;
+            }
+
+            uint32_t instanceCount = std::min(draw.instanceCount, s_spritesPerBundle - chunkSpriteCount);
+
+            chunks.back().push_back(SpriteDraw {
+                .textureBindGroup = draw.textureBindGroup,
+                .firstInstance = draw.firstInstance,
+                .instanceCount = instanceCount,
+            });
+
+            draw.firstInstance += instanceCount;
+            draw.instanceCount -= instanceCount;
+            chunkSpriteCount += instanceCount;
+        }
+    }
 
-    static std::array<glm::vec2, 12> vertices = {
-        glm::vec2(0.5f, 0.5f),  glm::vec2(1.0f, 1.0f),  glm::vec2(0.5f, -0.5f),
-        glm::vec2(1.0f, 0.0f),  glm::vec2(-0.5f, 0.5f), glm::vec2(0.0f, 1.0f),
+    return chunks;
+}
 
-        glm::vec2(0.5f, -0.5f), glm::vec2(1.0f, 0.0f),  glm::vec2(-0.5f, -0.5f),
-        glm::vec2(0.0f, 0.0f),  glm::vec2(-0.5f, 0.5f), glm::vec2(0.0f, 1.0f),
+// Safe to call from any thread, as long as every bind group and the pipeline have been created up front.
+static WGPURenderBundle encodeBundle(
+    WGPUDevice device, WGPUTextureFormat colorFormat, const SpriteBindings &bindings,
+    std::span<const SpriteDraw> draws
+) {
+    WGPURenderBundleEncoderDescriptor renderBundleEncoderDescriptor = {
+        .nextInChain = nullptr,
+        .label = "Sprite render bundle encoder",
+        .colorFormatCount = 1,
+        .colorFormats = &colorFormat,
+        .depthStencilFormat = WGPUTextureFormat_Undefined,
+        .sampleCount = 1,
+        .depthReadOnly = false,
+        .stencilReadOnly = false,
     };
+    WGPURenderBundleEncoder renderBundleEncoder =
+        wgpuDeviceCreateRenderBundleEncoder(device, &renderBundleEncoderDescriptor);
+
+    wgpuRenderBundleEncoderSetPipeline(renderBundleEncoder, bindings.pipeline);
+    wgpuRenderBundleEncoderSetBindGroup(
+        renderBundleEncoder, 0, bindings.cameraBindGroup, 1, &bindings.cameraUniformOffset
+    );
+    wgpuRenderBundleEncoderSetVertexBuffer(
+        renderBundleEncoder, 0, bindings.instanceBuffer, bindings.instanceOffset, bindings.instanceSize
+    );
+
+    for (const auto &draw : draws) {
+        wgpuRenderBundleEncoderSetBindGroup(renderBundleEncoder, 1, draw.textureBindGroup, 0, nullptr);
+        wgpuRenderBundleEncoderDraw(renderBundleEncoder, 6, draw.instanceCount, 0, draw.firstInstance);
+    }
 
-    WGPUBufferDescriptor vertexBufferDescriptor = {
+    WGPURenderBundleDescriptor renderBundleDescriptor = {
         .nextInChain = nullptr,
-        .label = "Vertex buffer",
-        .usage = WGPUBufferUsage_CopyDst | WGPUBufferUsage_Vertex,
-        .size = 6 * (2 * sizeof(float) + 2 * sizeof(float)),
-        .mappedAtCreation = false,
+        .label = "Sprite render bundle",
     };
-    WGPUBuffer vertexBuffer = wgpuDeviceCreateBuffer(device, &vertexBufferDescriptor);
+    WGPURenderBundle renderBundle = wgpuRenderBundleEncoderFinish(renderBundleEncoder, &renderBundleDescriptor);
 
-    wgpuQueueWriteBuffer(queue, vertexBuffer, 0, vertices.data(), 6 * (2 * sizeof(float) + 2 * sizeof(float)));
+    wgpuRenderBundleEncoderRelease(renderBundleEncoder);
 
-    return { device, queue, surfaceCapabilities, std::move(shader), vertexBuffer };
+    return renderBundle;
 }
 
-void Renderer::renderScene(
-    WGPUCommandEncoder commandEncoder, WGPUTextureView renderTarget, OrthographicCamera &camera, Scene &scene
+static std::array<uint16_t, 4> packUvRect(glm::vec4 uvRect) {
+    auto packed = glm::round(glm::clamp(uvRect, 0.0f, 1.0f) * 65535.0f);
+
+    return {
+        static_cast<uint16_t>(packed.x),
+        static_cast<uint16_t>(packed.y),
+        static_cast<uint16_t>(packed.z),
+        static_cast<uint16_t>(packed.w),
+    };
+}
+
+// Sprites in draw order. Instances stay where they were collected, the sorted draw items reference them.
+struct SpriteList {
+        std::vector<SpriteInstance> unsortedInstances;
+        std::vector<DrawItem> drawItems;
+        std::vector<SpriteBatch> batches;
+};
+
+// Every sprite gets a draw key, sorting them gives the final draw order.
+// Small textures live in the texture pool, letting sprites with different textures share a draw call.
+// Only sprites which are static or not, as requested, are collected.
+static SpriteList collectSprites(
+    WGPUCommandEncoder commandEncoder, TexturePool &texturePool, Scene &scene, BlendMode blendMode,
+    std::span<const entt::entity> entities, bool isStatic
 ) {
-    std::array<WGPUVertexAttribute, 2> attributes = {
-        WGPUVertexAttribute {
-            .format = WGPUVertexFormat_Float32x2,
-            .offset = 0,
-            .shaderLocation = 0,
-        },
-        WGPUVertexAttribute {
-            .format = WGPUVertexFormat_Float32x2,
-            .offset = sizeof(glm::vec2),
-            .shaderLocation = 1,
+    SpriteList sprites;
+
+    std::vector<WGPUTextureView> unsortedTextureViews;
+
+    auto group = scene.sprites();
+    auto interpolationAlpha = scene.interpolationAlpha();
+
+    for (auto entity : entities) {
+        auto [transform, sprite] = group.get<WorldTransformComponent, SpriteComponent>(entity);
+
+        if (sprite.texture == nullptr || sprite.isStatic != isStatic)
+            continue;
+
+        auto position = transform.position;
+        auto rotation = transform.rotation;
+
+        // Moving rigidbodies are drawn between their last two fixed steps
+        const auto *previous = scene.registry().try_get<PreviousWorldTransformComponent>(entity);
+
+        if (previous != nullptr) {
+            position = glm::mix(previous->position, transform.position, interpolationAlpha);
+            rotation = glm::mix(previous->rotation, transform.rotation, interpolationAlpha);
+        }
+
+        auto textureRegion = texturePool.region(commandEncoder, *sprite.texture);
+
+        sprites.drawItems.push_back(DrawItem {
+            .key = drawKey(sprite.sortingLayer, sprite.orderInLayer, blendMode, textureRegion.view),
+            .instanceIndex = static_cast<uint32_t>(sprites.unsortedInstances.size()),
+        });
+
+        sprites.unsortedInstances.push_back(SpriteInstance {
+            .position = position,
+            .scale = transform.scale,
+            .rotation = rotation,
+            .layer = textureRegion.layer,
+            .uvRect = packUvRect(textureRegion.uvRect),
+        });
+        unsortedTextureViews.push_back(textureRegion.view);
+    }
+
+    std::vector<DrawItem> drawItemsScratch;
+
+    radixSort(sprites.drawItems, drawItemsScratch, [](const DrawItem &drawItem) { return drawItem.key; });
+
+    // Consecutive sprites sampling the same texture view form a batch drawn with a single instanced draw call.
+    for (uint32_t drawIndex = 0; drawIndex < sprites.drawItems.size(); drawIndex++) {
+        auto textureView = unsortedTextureViews[sprites.drawItems[drawIndex].instanceIndex];
+
+        if (sprites.batches.empty() || sprites.batches.back().textureView != textureView) {
+            sprites.batches.push_back(SpriteBatch {
+                .textureView = textureView,
+                .firstInstance = drawIndex,
+                .instanceCount = 0,
+            });
+        }
+
+        sprites.batches.back().instanceCount += 1;
+    }
+
+    return sprites;
+}
+
+// Copies the instances in draw order.
+static void writeInstances(const SpriteList &sprites, uint8_t *instanceData) {
+    for (const auto &drawItem : sprites.drawItems) {
+        std::memcpy(instanceData, &sprites.unsortedInstances[drawItem.instanceIndex], sizeof(SpriteInstance));
+
+        instanceData += sizeof(SpriteInstance);
+    }
+}
+
+Renderer::~Renderer() {
+    for (const auto &staticBundle : staticRenderBundles) {
+        wgpuRenderBundleRelease(staticBundle.renderBundle);
+    }
+
+    if (staticInstanceBuffer != nullptr) {
+        wgpuBufferRelease(staticInstanceBuffer);
+    }
+
+    if (staticUniformBuffer != nullptr) {
+        wgpuBufferRelease(staticUniformBuffer);
+    }
+
+    for (auto &[uniformBuffer, bindGroup] : cameraBindGroups) {
+        wgpuBindGroupRelease(bindGroup);
+    }
+}
+
+Renderer Renderer::create(
+    WGPUDevice device, WGPUQueue queue, WGPUSurfaceCapabilities surfaceCapabilities, const std::string &shaderPath
+) {
+    auto shader = Shader::createFromFile(device, shaderPath);
+
+    std::vector<WGPUVertexBufferLayout> vertexBufferLayouts = {
+        WGPUVertexBufferLayout {
+            .arrayStride = sizeof(SpriteInstance),
+            .stepMode = WGPUVertexStepMode_Instance,
+            .attributeCount = s_instanceAttributes.size(),
+            .attributes = s_instanceAttributes.data(),
         },
     };
-    WGPUVertexBufferLayout vertexBufferLayout = {
-        .arrayStride = (2 * sizeof(float) + 2 * sizeof(float)),
-        .stepMode = WGPUVertexStepMode_Vertex,
-        .attributeCount = attributes.size(),
-        .attributes = attributes.data(),
-    };
-    WGPUVertexState vertexState = {
-        .module = shader->shaderModule(),
-        .entryPoint = "vs_main",
-        .bufferCount = 1,
-        .buffers = &vertexBufferLayout,
+
+    auto renderCache =
+        RenderCache::create(device, shader->shaderModule(), std::move(vertexBufferLayouts), sizeof(Uniforms));
+
+    auto texturePool = TexturePool::create(device);
+
+    // The main thread encodes a share of the bundles too
+    auto threadPool = std::make_unique<ThreadPool>(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+
+    WGPUSupportedLimits supportedLimits = {};
+    wgpuDeviceGetLimits(device, &supportedLimits);
+
+    uint64_t uniformAlignment = supportedLimits.limits.minUniformBufferOffsetAlignment;
+
+    // Copy source, static sprites read the camera from their own uniform buffer
+    auto uniformRing =
+        UploadRing::create(device, queue, WGPUBufferUsage_Uniform | WGPUBufferUsage_CopySrc, 64 * 1024);
+    auto instanceRing = UploadRing::create(device, queue, WGPUBufferUsage_Vertex, 4 * 1024 * 1024);
+
+    return {
+        device,
+        queue,
+        surfaceCapabilities,
+        std::move(shader),
+        std::move(renderCache),
+        std::move(texturePool),
+        std::move(threadPool),
+        std::move(uniformRing),
+        std::move(instanceRing),
+        uniformAlignment,
     };
+}
 
-    WGPUBlendState blendState = { .color =
-                                      WGPUBlendComponent {
-                                          .operation = WGPUBlendOperation_Add,
-                                          .srcFactor = WGPUBlendFactor_SrcAlpha,
-                                          .dstFactor = WGPUBlendFactor_OneMinusSrcAlpha,
-                                      },
-                                  .alpha = WGPUBlendComponent {
-                                      .operation = WGPUBlendOperation_Add,
-                                      .srcFactor = WGPUBlendFactor_Zero,
-                                      .dstFactor = WGPUBlendFactor_One,
-                                  } };
-    WGPUColorTargetState targets[] = {
-        WGPUColorTargetState {
-            .format = WGPUTextureFormat_RGBA8Unorm,
-            .blend = &blendState,
-            .writeMask = WGPUColorWriteMask_All,
-        },
+void Renderer::renderScene(
+    WGPUCommandEncoder commandEncoder, WGPUTextureView renderTarget, OrthographicCamera &camera, Scene &scene
+) {
+    RendererStatistics statistics {};
+
+    auto createdObjectCount = renderCache->createdObjectCount();
+
+    // Sprites are drawn with their world transforms, the spatial index is kept in sync with them as well.
+    scene.updateWorldTransforms();
+
+    auto cameraBounds = camera.bounds();
+
+    // Only sprites intersecting the camera's view are considered, looked up in the scene's spatial index.
+    std::vector<entt::entity> visibleEntities;
+
+    scene.querySprites(cameraBounds, visibleEntities);
+
+    RenderState renderState = {
+        .colorFormat = WGPUTextureFormat_RGBA8Unorm,
+        .blendMode = BlendMode::Alpha,
     };
-    WGPUFragmentState fragmentState = {
-        .module = shader->shaderModule(),
-        .entryPoint = "fs_main",
-        .targetCount = 1,
-        .targets = targets,
+
+    if (scene.staticSpritesVersion() != staticSpritesVersion) {
+        recordStaticSprites(commandEncoder, scene, renderState);
+    }
+
+    // Static sprites are drawn from the recordings of the buckets in view instead, still in draw order.
+    auto sprites = collectSprites(commandEncoder, *texturePool, scene, renderState.blendMode, visibleEntities, false);
+
+    std::vector<const StaticSpriteBundle *> staticBundles;
+
+    for (const auto &staticBundle : staticRenderBundles) {
+        if (staticBundle.bounds.intersects(cameraBounds)) {
+            staticBundles.push_back(&staticBundle);
+        }
+    }
+
+    uniformRing->beginFrame();
+    instanceRing->beginFrame();
+
+    auto createdBufferCount = uniformRing->createdBufferCount() + instanceRing->createdBufferCount();
+
+    Uniforms uniforms = {
+        .viewProjectionMatrix = camera.viewProjectionMatrix(),
     };
 
-    WGPUSamplerDescriptor samplerDescriptor = {
-        .addressModeU = WGPUAddressMode_ClampToEdge,
-        .addressModeV = WGPUAddressMode_ClampToEdge,
-        .addressModeW = WGPUAddressMode_ClampToEdge,
-        .magFilter = WGPUFilterMode_Linear,
-        .minFilter = WGPUFilterMode_Linear,
-        .mipmapFilter = WGPUMipmapFilterMode_Linear,
-        .lodMinClamp = 0.0f,
-        .lodMaxClamp = 1.0f,
-        .compare = WGPUCompareFunction_Undefined,
-        .maxAnisotropy = 1,
+    auto uniformAllocation = uniformRing->allocate(sizeof(Uniforms), uniformAlignment);
+
+    std::memcpy(uniformAllocation.data.data(), &uniforms, sizeof(Uniforms));
+
+    if (!staticBundles.empty()) {
+        wgpuCommandEncoderCopyBufferToBuffer(
+            commandEncoder, uniformAllocation.buffer, uniformAllocation.offset, staticUniformBuffer, 0, sizeof(Uniforms)
+        );
+    }
+
+    uint64_t instanceDataSize = sprites.drawItems.size() * sizeof(SpriteInstance);
+
+    std::optional<UploadAllocation> instanceAllocation;
+
+    if (instanceDataSize > 0) {
+        instanceAllocation = instanceRing->allocate(instanceDataSize, sizeof(SpriteInstance));
+
+        // Instances are written straight into the upload buffer in draw order, without an intermediate copy.
+        writeInstances(sprites, instanceAllocation->data.data());
+    }
+
+    uniformRing->flush();
+    instanceRing->flush();
+
+    std::optional<WGPURenderPassTimestampWrites> timestampWrites;
+
+    if (gpuProfiler != nullptr) {
+        timestampWrites = gpuProfiler->timestampWrites("Scene");
+    }
+
+    // A single pass is always encoded, even for an empty scene, so the render target is cleared every frame.
+    WGPURenderPassColorAttachment renderPassColorAttachment = {
+        .view = renderTarget,
+        .resolveTarget = nullptr,
+        .loadOp = WGPULoadOp_Clear,
+        .storeOp = WGPUStoreOp_Store,
+        .clearValue = WGPUColor { 0.0, 0.0, 0.0, 1.0 },
+    };
+    WGPURenderPassDescriptor renderPassDescriptor = {
+        .nextInChain = nullptr,
+        .colorAttachmentCount = 1,
+        .colorAttachments = &renderPassColorAttachment,
+        .depthStencilAttachment = nullptr,
+        .timestampWrites = timestampWrites.has_value() ? &timestampWrites.value() : nullptr,
     };
-    WGPUSampler sampler = wgpuDeviceCreateSampler(device, &samplerDescriptor);
+    WGPURenderPassEncoder renderPassEncoder = wgpuCommandEncoderBeginRenderPass(commandEncoder, &renderPassDescriptor);
+
+    statistics.renderPasses += 1;
+
+    // Static sprites are culled by bucket, the spatial index returns visible ones along with the dynamic ones
+    size_t visibleDynamicSpriteCount = 0;
+
+    for (auto entity : visibleEntities) {
+        if (!scene.registry().get<SpriteComponent>(entity).isStatic) {
+            visibleDynamicSpriteCount += 1;
+        }
+    }
 
-    bool isFirst = true;
+    uint32_t drawnStaticSpriteCount = 0;
 
-    for (Entity &entity : scene.entities()) {
-        if (!entity.hasComponent<TransformComponent>() || !entity.hasComponent<SpriteComponent>())
+    for (const auto *staticBundle : staticBundles) {
+        drawnStaticSpriteCount += staticBundle->spriteCount;
+    }
+
+    auto dynamicSpriteCount = scene.spriteCount() - staticSpriteCount - texturelessStaticSpriteCount;
+
+    statistics.culledSprites = static_cast<uint32_t>(
+        dynamicSpriteCount - visibleDynamicSpriteCount + staticSpriteCount - drawnStaticSpriteCount
+    );
+
+    // Every static bundle goes right before the first dynamic sprite sorted after it, so dynamic sprites between the
+    // bundles' layers are drawn between them.
+    std::vector<uint32_t> staticBoundaries;
+
+    for (const auto *staticBundle : staticBundles) {
+        auto boundary = std::partition_point(
+            sprites.drawItems.begin(), sprites.drawItems.end(),
+            [&](const DrawItem &drawItem) { return drawOrder(drawItem.key) < staticBundle->drawOrder; }
+        );
+
+        staticBoundaries.push_back(static_cast<uint32_t>(boundary - sprites.drawItems.begin()));
+    }
+
+    // Everything the draws reference is resolved here, the caches aren't safe to use from worker threads.
+    SpriteBindings bindings {};
+    std::vector<SpriteDraw> draws;
+
+    if (instanceAllocation.has_value()) {
+        bindings = SpriteBindings {
+            .pipeline = renderCache->pipeline(renderState),
+            .cameraBindGroup = cameraBindGroup(uniformAllocation.buffer),
+            .cameraUniformOffset = static_cast<uint32_t>(uniformAllocation.offset),
+            .instanceBuffer = instanceAllocation->buffer,
+            .instanceOffset = instanceAllocation->offset,
+            .instanceSize = instanceDataSize,
+        };
+
+        for (const auto &batch : sprites.batches) {
+            draws.push_back(SpriteDraw {
+                .textureBindGroup = renderCache->textureBindGroup(batch.textureView),
+                .firstInstance = batch.firstInstance,
+                .instanceCount = batch.instanceCount,
+            });
+        }
+    }
+
+    // Dynamic draws before each static bundle, the last run is drawn after all of them.
+    auto runs = splitDraws(draws, staticBoundaries);
+
+    if (sprites.drawItems.size() < 2 * s_spritesPerBundle || threadPool->threadCount() == 0) {
+        for (size_t runIndex = 0; runIndex < runs.size(); runIndex++) {
+            // Executing a bundle resets the pass' state, every run binds everything again
+            if (!runs[runIndex].empty()) {
+                encodeDraws(renderPassEncoder, bindings, runs[runIndex]);
+
+                statistics.drawCalls += static_cast<uint32_t>(runs[runIndex].size());
+            }
+
+            if (runIndex < staticBundles.size()) {
+                wgpuRenderPassEncoderExecuteBundles(renderPassEncoder, 1, &staticBundles[runIndex]->renderBundle);
+            }
+        }
+    } else {
+        // Every run is split into chunks of similar size, each encoded into its own render bundle on the thread pool.
+        // Executing them in order, with the static bundles in between, keeps the draw order intact.
+        std::vector<std::vector<SpriteDraw>> chunks;
+        std::vector<size_t> runChunkCounts;
+
+        for (const auto &run : runs) {
+            auto runChunks = run.empty() ? std::vector<std::vector<SpriteDraw>>() : chunkDraws(run);
+
+            runChunkCounts.push_back(runChunks.size());
+            chunks.insert(chunks.end(), runChunks.begin(), runChunks.end());
+        }
+
+        std::vector<WGPURenderBundle> chunkRenderBundles(chunks.size());
+
+        threadPool->parallelFor(chunks.size(), [&](size_t chunkIndex) {
+            chunkRenderBundles[chunkIndex] =
+                encodeBundle(device, renderState.colorFormat, bindings, chunks[chunkIndex]);
+        });
+
+        std::vector<WGPURenderBundle> renderBundles;
+        size_t chunkIndex = 0;
+
+        for (size_t runIndex = 0; runIndex < runs.size(); runIndex++) {
+            for (size_t runChunkIndex = 0; runChunkIndex < runChunkCounts[runIndex]; runChunkIndex++) {
+                renderBundles.push_back(chunkRenderBundles[chunkIndex++]);
+            }
+
+            if (runIndex < staticBundles.size()) {
+                renderBundles.push_back(staticBundles[runIndex]->renderBundle);
+            }
+        }
+
+        wgpuRenderPassEncoderExecuteBundles(renderPassEncoder, renderBundles.size(), renderBundles.data());
+
+        for (auto renderBundle : chunkRenderBundles) {
+            wgpuRenderBundleRelease(renderBundle);
+        }
+
+        for (const auto &chunk : chunks) {
+            statistics.drawCalls += static_cast<uint32_t>(chunk.size());
+        }
+
+        statistics.renderBundles += static_cast<uint32_t>(chunkRenderBundles.size());
+    }
+
+    statistics.sprites += static_cast<uint32_t>(sprites.drawItems.size());
+
+    for (const auto *staticBundle : staticBundles) {
+        statistics.drawCalls += staticBundle->drawCallCount;
+        statistics.renderBundles += 1;
+        statistics.sprites += staticBundle->spriteCount;
+        statistics.staticSprites += staticBundle->spriteCount;
+    }
+
+    wgpuRenderPassEncoderEnd(renderPassEncoder);
+    wgpuRenderPassEncoderRelease(renderPassEncoder);
+
+    statistics.createdGpuObjects += static_cast<uint32_t>(renderCache->createdObjectCount() - createdObjectCount);
+    statistics.createdGpuObjects += static_cast<uint32_t>(
+        uniformRing->createdBufferCount() + instanceRing->createdBufferCount() - createdBufferCount
+    );
+
+    lastFrameStatistics = statistics;
+}
+
+void Renderer::recordStaticSprites(WGPUCommandEncoder commandEncoder, Scene &scene, const RenderState &renderState) {
+    for (const auto &staticBundle : staticRenderBundles) {
+        wgpuRenderBundleRelease(staticBundle.renderBundle);
+    }
+
+    staticRenderBundles.clear();
+
+    staticSpritesVersion = scene.staticSpritesVersion();
+    staticSpriteCount = 0;
+    texturelessStaticSpriteCount = 0;
+
+    // Bucketed by the grid cell their position falls into, every bucket is recorded and culled on its own.
+    // The group is walked in its packed order, so collecting the sprites walks its arrays sequentially.
+    std::unordered_map<uint64_t, std::vector<entt::entity>> bucketEntities;
+
+    for (auto [entity, transform, sprite] : scene.sprites().each()) {
+        if (!sprite.isStatic)
             continue;
 
-        auto &transform = entity.getComponent<TransformComponent>();
-        auto &sprite = entity.getComponent<SpriteComponent>();
+        if (sprite.texture == nullptr) {
+            texturelessStaticSpriteCount += 1;
 
-        if (sprite.texture == nullptr)
             continue;
+        }
+
+        auto cell = glm::ivec2(glm::floor(transform.position / s_staticBucketSize));
+        auto cellKey = (static_cast<uint64_t>(static_cast<uint32_t>(cell.x)) << 32) | static_cast<uint32_t>(cell.y);
 
-        glm::mat4 transformMatrix = glm::translate(glm::mat4(1.0f), glm::vec3(transform.position, 0.0f)) *
-                                    glm::rotate(glm::mat4(1.0f), -transform.rotation, glm::vec3(0.0f, 0.0f, 1.0f)) *
-                                    glm::scale(glm::mat4(1.0f), glm::vec3(transform.scale, 1.0f));
+        bucketEntities[cellKey].push_back(entity);
+    }
 
-        glm::mat4 viewProjectionMatrix = camera.viewProjectionMatrix();
+    if (bucketEntities.empty())
+        return;
 
-        Uniforms uniforms = {
-            .transformMatrix = transformMatrix,
-            .viewProjectionMatrix = viewProjectionMatrix,
-        };
+    struct StaticBucket {
+            SpriteList sprites;
+            BoundingBox bounds;
+            uint32_t firstInstance;
+    };
 
-        WGPUBufferDescriptor uniformBufferDescriptor = {
-            .usage = WGPUBufferUsage_CopyDst | WGPUBufferUsage_Uniform,
-            .size = sizeof(uniforms),
-            .mappedAtCreation = false,
-        };
-        WGPUBuffer uniformBuffer = wgpuDeviceCreateBuffer(device, &uniformBufferDescriptor);
-
-        wgpuQueueWriteBuffer(queue, uniformBuffer, 0, &uniforms, sizeof(uniforms));
-
-        std::array<WGPUBindGroupLayoutEntry, 3> bindGroupLayoutEntries = {
-            WGPUBindGroupLayoutEntry {
-                .nextInChain = nullptr,
-                .binding = 0,
-                .visibility = WGPUShaderStage_Fragment,
-                .texture =
-                    WGPUTextureBindingLayout {
-                        .nextInChain = nullptr,
-                        .sampleType = WGPUTextureSampleType_Float,
-                        .viewDimension = WGPUTextureViewDimension_2D,
-                        .multisampled = false,
-                    },
-            },
-            WGPUBindGroupLayoutEntry {
-                .binding = 1,
-                .visibility = WGPUShaderStage_Fragment,
-                .sampler =
-                    WGPUSamplerBindingLayout {
-                        .type = WGPUSamplerBindingType_Filtering,
-                    },
-            },
-            WGPUBindGroupLayoutEntry {
-                .binding = 2,
-                .visibility = WGPUShaderStage_Vertex,
-                .buffer =
-                    WGPUBufferBindingLayout {
-                        .type = WGPUBufferBindingType_Uniform,
-                        .minBindingSize = sizeof(Uniforms),
-                    },
-            },
-        };
-        WGPUBindGroupLayoutDescriptor bindGroupLayoutDescriptor = {
-            .nextInChain = nullptr,
-            .entryCount = bindGroupLayoutEntries.size(),
-            .entries = bindGroupLayoutEntries.data(),
-        };
-        WGPUBindGroupLayout bindGroupLayout = wgpuDeviceCreateBindGroupLayout(device, &bindGroupLayoutDescriptor);
-
-        std::array<WGPUBindGroupEntry, 3> bindGroupEntries = {
-            WGPUBindGroupEntry {
-                .nextInChain = nullptr,
-                .binding = 0,
-                .textureView = sprite.texture->view(),
-            },
-            WGPUBindGroupEntry {
-                .nextInChain = nullptr,
-                .binding = 1,
-                .sampler = sampler,
-            },
-            WGPUBindGroupEntry {
-                .nextInChain = nullptr,
-                .binding = 2,
-                .buffer = uniformBuffer,
-                .offset = 0,
-                .size = sizeof(Uniforms),
-            },
-        };
-        WGPUBindGroupDescriptor bindGroupDescriptor = {
+    std::vector<StaticBucket> buckets;
+    uint32_t instanceCount = 0;
+
+    for (const auto &[cellKey, entities] : bucketEntities) {
+        auto bounds = Scene::spriteBounds(scene.registry().get<WorldTransformComponent>(entities.front()));
+
+        for (auto entity : entities) {
+            auto spriteBounds = Scene::spriteBounds(scene.registry().get<WorldTransformComponent>(entity));
+
+            bounds.min = glm::min(bounds.min, spriteBounds.min);
+            bounds.max = glm::max(bounds.max, spriteBounds.max);
+        }
+
+        buckets.push_back(StaticBucket {
+            .sprites = collectSprites(commandEncoder, *texturePool, scene, renderState.blendMode, entities, true),
+            .bounds = bounds,
+            .firstInstance = instanceCount,
+        });
+
+        instanceCount += static_cast<uint32_t>(buckets.back().sprites.drawItems.size());
+    }
+
+    uint64_t instanceDataSize = instanceCount * sizeof(SpriteInstance);
+
+    if (staticInstanceBufferSize < instanceDataSize) {
+        if (staticInstanceBuffer != nullptr) {
+            wgpuBufferRelease(staticInstanceBuffer);
+        }
+
+        WGPUBufferDescriptor bufferDescriptor = {
             .nextInChain = nullptr,
-            .layout = bindGroupLayout,
-            .entryCount = bindGroupEntries.size(),
-            .entries = bindGroupEntries.data(),
+            .label = "Static sprite instance buffer",
+            .usage = WGPUBufferUsage_Vertex | WGPUBufferUsage_CopyDst,
+            .size = instanceDataSize,
+            .mappedAtCreation = false,
         };
-        WGPUBindGroup bindGroup = wgpuDeviceCreateBindGroup(device, &bindGroupDescriptor);
+        staticInstanceBuffer = wgpuDeviceCreateBuffer(device, &bufferDescriptor);
+        staticInstanceBufferSize = instanceDataSize;
+    }
 
-        WGPUPipelineLayoutDescriptor pipelineLayoutDescriptor = {
+    if (staticUniformBuffer == nullptr) {
+        WGPUBufferDescriptor bufferDescriptor = {
             .nextInChain = nullptr,
-            .label = "Pipeline layout",
-            .bindGroupLayoutCount = 1,
-            .bindGroupLayouts = &bindGroupLayout,
-        };
-        WGPUPipelineLayout pipelineLayout = wgpuDeviceCreatePipelineLayout(device, &pipelineLayoutDescriptor);
-
-        WGPURenderPipelineDescriptor renderPipelineDescriptor = {
-            .label = "Render pipeline",
-            .layout = pipelineLayout,
-            .vertex = vertexState,
-            .primitive =
-                WGPUPrimitiveState {
-                    .topology = WGPUPrimitiveTopology_TriangleList,
-                },
-            .multisample =
-                WGPUMultisampleState {
-                    .count = 1,
-                    .mask = 0xFFFFFFFF,
-                },
-            .fragment = &fragmentState,
-        };
-        WGPURenderPipeline renderPipeline = wgpuDeviceCreateRenderPipeline(device, &renderPipelineDescriptor);
-
-        WGPURenderPassColorAttachment renderPassColorAttachment = {
-            .view = renderTarget,
-            .resolveTarget = nullptr,
-            .loadOp = isFirst ? WGPULoadOp_Clear : WGPULoadOp_Load,
-            .storeOp = WGPUStoreOp_Store,
-            .clearValue = WGPUColor { 0.0, 0.0, 0.0, 1.0 },
+            .label = "Static sprite uniform buffer",
+            .usage = WGPUBufferUsage_Uniform | WGPUBufferUsage_CopyDst,
+            .size = sizeof(Uniforms),
+            .mappedAtCreation = false,
         };
-        WGPURenderPassDescriptor renderPassDescriptor = {
-            .nextInChain = nullptr,
-            .colorAttachmentCount = 1,
-            .colorAttachments = &renderPassColorAttachment,
-            .depthStencilAttachment = nullptr,
-            .timestampWrites = nullptr,
+        staticUniformBuffer = wgpuDeviceCreateBuffer(device, &bufferDescriptor);
+    }
+
+    std::vector<uint8_t> instanceData(instanceDataSize);
+
+    for (const auto &bucket : buckets) {
+        writeInstances(bucket.sprites, instanceData.data() + bucket.firstInstance * sizeof(SpriteInstance));
+    }
+
+    wgpuQueueWriteBuffer(queue, staticInstanceBuffer, 0, instanceData.data(), instanceDataSize);
+
+    for (const auto &bucket : buckets) {
+        const auto &sprites = bucket.sprites;
+
+        // The camera changes every frame, it's copied into the static uniform buffer rather than baked into the
+        // bundles. Every bucket binds its own instances, so draws index them from zero.
+        SpriteBindings bindings = {
+            .pipeline = renderCache->pipeline(renderState),
+            .cameraBindGroup = cameraBindGroup(staticUniformBuffer),
+            .cameraUniformOffset = 0,
+            .instanceBuffer = staticInstanceBuffer,
+            .instanceOffset = bucket.firstInstance * sizeof(SpriteInstance),
+            .instanceSize = sprites.drawItems.size() * sizeof(SpriteInstance),
         };
-        WGPURenderPassEncoder renderPassEncoder =
-            wgpuCommandEncoderBeginRenderPass(commandEncoder, &renderPassDescriptor);
 
-        wgpuRenderPassEncoderSetPipeline(renderPassEncoder, renderPipeline);
-        wgpuRenderPassEncoderSetBindGroup(renderPassEncoder, 0, bindGroup, 0, nullptr);
-        wgpuRenderPassEncoderSetVertexBuffer(
-            renderPassEncoder, 0, quadVertexBuffer, 0, 6 * (2 * sizeof(float) + 2 * sizeof(float))
-        );
+        std::vector<SpriteDraw> draws;
+
+        for (const auto &batch : sprites.batches) {
+            draws.push_back(SpriteDraw {
+                .textureBindGroup = renderCache->textureBindGroup(batch.textureView),
+                .firstInstance = batch.firstInstance,
+                .instanceCount = batch.instanceCount,
+            });
+        }
+
+        // One bundle per draw order, so dynamic sprites can be drawn in between
+        std::vector<uint32_t> orderChanges;
+
+        for (uint32_t drawIndex = 1; drawIndex < sprites.drawItems.size(); drawIndex++) {
+            if (drawOrder(sprites.drawItems[drawIndex].key) != drawOrder(sprites.drawItems[drawIndex - 1].key)) {
+                orderChanges.push_back(drawIndex);
+            }
+        }
+
+        auto runs = splitDraws(draws, orderChanges);
+
+        for (const auto &run : runs) {
+            uint32_t spriteCount = 0;
+
+            for (const auto &draw : run) {
+                spriteCount += draw.instanceCount;
+            }
+
+            staticRenderBundles.push_back(StaticSpriteBundle {
+                .drawOrder = drawOrder(sprites.drawItems[run.front().firstInstance].key),
+                .bounds = bucket.bounds,
+                .renderBundle = encodeBundle(device, renderState.colorFormat, bindings, run),
+                .spriteCount = spriteCount,
+                .drawCallCount = static_cast<uint32_t>(run.size()),
+            });
+        }
+    }
 
-        wgpuRenderPassEncoderDraw(renderPassEncoder, 6, 1, 0, 0);
+    // Bundles of a draw order may be executed in any order, only the draw orders have to be ascending
+    std::stable_sort(
+        staticRenderBundles.begin(), staticRenderBundles.end(),
+        [](const StaticSpriteBundle &left, const StaticSpriteBundle &right) {
+            return left.drawOrder < right.drawOrder;
+        }
+    );
 
-        wgpuRenderPassEncoderEnd(renderPassEncoder);
+    staticSpriteCount = instanceCount;
+}
 
-        wgpuRenderPipelineRelease(renderPipeline);
-        wgpuPipelineLayoutReference(pipelineLayout);
-        wgpuBindGroupRelease(bindGroup);
-        wgpuBindGroupLayoutRelease(bindGroupLayout);
-        wgpuBufferRelease(uniformBuffer);
+WGPUBindGroup Renderer::cameraBindGroup(WGPUBuffer uniformBuffer) {
+    auto result = cameraBindGroups.find(uniformBuffer);
 
-        isFirst = false;
+    if (result != cameraBindGroups.end()) {
+        return result->second;
     }
 
-    wgpuSamplerRelease(sampler);
+    WGPUBindGroupEntry bindGroupEntry = {
+        .nextInChain = nullptr,
+        .binding = 0,
+        .buffer = uniformBuffer,
+        .offset = 0,
+        .size = sizeof(Uniforms),
+    };
+    WGPUBindGroupDescriptor bindGroupDescriptor = {
+        .nextInChain = nullptr,
+        .label = "Camera bind group",
+        .layout = renderCache->cameraBindGroupLayout(),
+        .entryCount = 1,
+        .entries = &bindGroupEntry,
+    };
+    WGPUBindGroup bindGroup = wgpuDeviceCreateBindGroup(device, &bindGroupDescriptor);
+
+    cameraBindGroups.emplace(uniformBuffer, bindGroup);
+
+    return bindGroup;
 }
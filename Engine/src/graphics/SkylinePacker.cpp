@@ -0,0 +1,100 @@
+#include "delusion/graphics/SkylinePacker.hpp"
+
+#include <algorithm>
+#include <limits>
+
+SkylinePacker::SkylinePacker(uint32_t width, uint32_t height) : m_width(width), m_height(height) {
+    reset();
+}
+
+std::optional<PackedPosition> SkylinePacker::pack(uint32_t width, uint32_t height) {
+    if (width == 0 || height == 0) {
+        return std::nullopt;
+    }
+
+    std::optional<size_t> bestSegmentIndex;
+    uint32_t bestY = std::numeric_limits<uint32_t>::max();
+    uint32_t bestX = std::numeric_limits<uint32_t>::max();
+
+    for (size_t segmentIndex = 0; segmentIndex < m_skyline.size(); segmentIndex++) {
+        auto y = fit(segmentIndex, width, height);
+
+        if (y.has_value() && (y.value() < bestY || (y.value() == bestY && m_skyline[segmentIndex].x < bestX))) {
+            bestSegmentIndex = segmentIndex;
+            bestY = y.value();
+            bestX = m_skyline[segmentIndex].x;
+        }
+    }
+
+    if (!bestSegmentIndex.has_value()) {
+        return std::nullopt;
+    }
+
+    auto index = bestSegmentIndex.value();
+
+    m_skyline.insert(m_skyline.begin() + static_cast<ptrdiff_t>(index), Segment { bestX, bestY + height, width });
+
+    // Shrink or remove the segments now covered by the new one.
+    for (size_t segmentIndex = index + 1; segmentIndex < m_skyline.size();) {
+        auto &previous = m_skyline[segmentIndex - 1];
+        auto &segment = m_skyline[segmentIndex];
+
+        auto previousEnd = previous.x + previous.width;
+
+        if (segment.x >= previousEnd) {
+            break;
+        }
+
+        auto shrink = previousEnd - segment.x;
+
+        if (segment.width <= shrink) {
+            m_skyline.erase(m_skyline.begin() + static_cast<ptrdiff_t>(segmentIndex));
+        } else {
+            segment.x += shrink;
+            segment.width -= shrink;
+
+            break;
+        }
+    }
+
+    // Merge neighbouring segments at the same height.
+    for (size_t segmentIndex = 1; segmentIndex < m_skyline.size();) {
+        if (m_skyline[segmentIndex - 1].y == m_skyline[segmentIndex].y) {
+            m_skyline[segmentIndex - 1].width += m_skyline[segmentIndex].width;
+
+            m_skyline.erase(m_skyline.begin() + static_cast<ptrdiff_t>(segmentIndex));
+        } else {
+            segmentIndex++;
+        }
+    }
+
+    return PackedPosition { bestX, bestY };
+}
+
+void SkylinePacker::reset() {
+    m_skyline.clear();
+    m_skyline.push_back(Segment { 0, 0, m_width });
+}
+
+std::optional<uint32_t> SkylinePacker::fit(size_t segmentIndex, uint32_t width, uint32_t height) const {
+    auto x = m_skyline[segmentIndex].x;
+
+    if (x + width > m_width) {
+        return std::nullopt;
+    }
+
+    uint32_t y = 0;
+    uint32_t remainingWidth = width;
+
+    for (size_t index = segmentIndex; index < m_skyline.size() && remainingWidth > 0; index++) {
+        y = std::max(y, m_skyline[index].y);
+
+        if (y + height > m_height) {
+            return std::nullopt;
+        }
+
+        remainingWidth -= std::min(remainingWidth, m_skyline[index].width);
+    }
+
+    return y;
+}
@@ -1,19 +1,107 @@
 #include "delusion/graphics/Texture2D.hpp"
 
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <unordered_map>
+
+// Intentionally leaked, textures can still be destroyed during static destruction (e.g. by the engine's asset manager)
+static auto *s_destroyListeners = new std::unordered_map<size_t, Texture2D::DestroyListener>();
+static size_t s_nextDestroyListenerHandle = 0;
+
+// Halves the image with a 2x2 box filter. Odd edges reuse their last row or column, so sizes round down.
+// Colors are weighted by alpha, keeping the color of transparent texels from bleeding into their neighbours.
+static Image downsample(Image &image) {
+    uint32_t width = std::max(image.width() / 2, 1u);
+    uint32_t height = std::max(image.height() / 2, 1u);
+
+    auto sourcePixels = image.pixels();
+    std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+
+    for (uint32_t y = 0; y < height; y++) {
+        for (uint32_t x = 0; x < width; x++) {
+            float red = 0.0f;
+            float green = 0.0f;
+            float blue = 0.0f;
+            float alpha = 0.0f;
+
+            for (uint32_t offsetY = 0; offsetY < 2; offsetY++) {
+                for (uint32_t offsetX = 0; offsetX < 2; offsetX++) {
+                    uint32_t sourceX = std::min(x * 2 + offsetX, image.width() - 1);
+                    uint32_t sourceY = std::min(y * 2 + offsetY, image.height() - 1);
+
+                    auto *texel = &sourcePixels[(static_cast<size_t>(sourceY) * image.width() + sourceX) * 4];
+                    auto texelAlpha = static_cast<float>(texel[3]);
+
+                    red += static_cast<float>(texel[0]) * texelAlpha;
+                    green += static_cast<float>(texel[1]) * texelAlpha;
+                    blue += static_cast<float>(texel[2]) * texelAlpha;
+                    alpha += texelAlpha;
+                }
+            }
+
+            auto *texel = &pixels[(static_cast<size_t>(y) * width + x) * 4];
+
+            if (alpha > 0.0f) {
+                texel[0] = static_cast<uint8_t>(std::lround(red / alpha));
+                texel[1] = static_cast<uint8_t>(std::lround(green / alpha));
+                texel[2] = static_cast<uint8_t>(std::lround(blue / alpha));
+                texel[3] = static_cast<uint8_t>(std::lround(alpha / 4.0f));
+            }
+        }
+    }
+
+    return { width, height, std::move(pixels) };
+}
+
+static void writeMipLevel(WGPUQueue queue, WGPUTexture texture, uint32_t mipLevel, Image &image) {
+    WGPUImageCopyTexture destination = {
+        .nextInChain = nullptr,
+        .texture = texture,
+        .mipLevel = mipLevel,
+        .origin = { 0, 0, 0 },
+        .aspect = WGPUTextureAspect_All,
+    };
+
+    WGPUTextureDataLayout source = {
+        .nextInChain = nullptr,
+        .offset = 0,
+        .bytesPerRow = 4 * image.width(),
+        .rowsPerImage = image.height(),
+    };
+
+    WGPUExtent3D size = { image.width(), image.height(), 1 };
+
+    wgpuQueueWriteTexture(queue, &destination, image.pixels().data(), image.pixels().size(), &source, &size);
+}
+
 Texture2D::~Texture2D() {
+    // Regions only borrow their page's texture and views.
+    if (isRegion())
+        return;
+
+    for (auto &[handle, listener] : *s_destroyListeners) {
+        listener(*this);
+    }
+
+    wgpuTextureViewRelease(m_arrayTextureView);
     wgpuTextureViewRelease(m_textureView);
     wgpuTextureRelease(m_texture);
 }
 
-std::unique_ptr<Texture2D> Texture2D::create(UniqueId id, WGPUDevice device, WGPUQueue queue, Image &image) {
+std::unique_ptr<Texture2D> Texture2D::create(
+    UniqueId id, WGPUDevice device, WGPUQueue queue, Image &image, uint32_t maxMipLevelCount
+) {
+    auto fullMipLevelCount = static_cast<uint32_t>(std::bit_width(std::max(image.width(), image.height())));
+
     WGPUTextureDescriptor textureDescriptor = {
         .nextInChain = nullptr,
         .label = "Texture2D",
-        .usage = WGPUTextureUsage_TextureBinding | WGPUTextureUsage_CopyDst,
+        .usage = WGPUTextureUsage_TextureBinding | WGPUTextureUsage_CopyDst | WGPUTextureUsage_CopySrc,
         .dimension = WGPUTextureDimension_2D,
         .size = WGPUExtent3D { image.width(), image.height(), 1 },
         .format = WGPUTextureFormat_RGBA8Unorm,
-        .mipLevelCount = 1,
+        .mipLevelCount = std::clamp(maxMipLevelCount, 1u, fullMipLevelCount),
         .sampleCount = 1,
         .viewFormatCount = 0,
         .viewFormats = nullptr,
@@ -25,39 +113,39 @@ std::unique_ptr<Texture2D> Texture2D::create(UniqueId id, WGPUDevice device, WGP
         .format = textureDescriptor.format,
         .dimension = WGPUTextureViewDimension_2D,
         .baseMipLevel = 0,
-        .mipLevelCount = 1,
+        .mipLevelCount = textureDescriptor.mipLevelCount,
         .baseArrayLayer = 0,
         .arrayLayerCount = 1,
         .aspect = WGPUTextureAspect_All,
     };
     WGPUTextureView textureView = wgpuTextureCreateView(texture, &textureViewDescriptor);
 
-    WGPUImageCopyTexture destination = {
-        .nextInChain = nullptr,
-        .texture = texture,
-        .mipLevel = 0,
-        .origin = { 0, 0, 0 },
-        .aspect = WGPUTextureAspect_All,
-    };
+    WGPUTextureViewDescriptor arrayTextureViewDescriptor = textureViewDescriptor;
+    arrayTextureViewDescriptor.dimension = WGPUTextureViewDimension_2DArray;
 
-    WGPUTextureDataLayout source = {
-        .nextInChain = nullptr,
-        .offset = 0,
-        .bytesPerRow = 4 * textureDescriptor.size.width,
-        .rowsPerImage = textureDescriptor.size.height,
-    };
+    WGPUTextureView arrayTextureView = wgpuTextureCreateView(texture, &arrayTextureViewDescriptor);
 
-    wgpuQueueWriteTexture(
-        queue, &destination, image.pixels().data(), image.pixels().size(), &source, &textureDescriptor.size
-    );
+    writeMipLevel(queue, texture, 0, image);
 
-    return std::unique_ptr<Texture2D>(new Texture2D(id, texture, textureView, image.width(), image.height()));
+    Image mipLevelImage = downsample(image);
+
+    for (uint32_t mipLevel = 1; mipLevel < textureDescriptor.mipLevelCount; mipLevel++) {
+        writeMipLevel(queue, texture, mipLevel, mipLevelImage);
+
+        if (mipLevel + 1 < textureDescriptor.mipLevelCount) {
+            mipLevelImage = downsample(mipLevelImage);
+        }
+    }
+
+    return std::unique_ptr<Texture2D>(new Texture2D(
+        id, texture, textureView, arrayTextureView, image.width(), image.height(), textureDescriptor.mipLevelCount
+    ));
 }
 
 std::unique_ptr<Texture2D> Texture2D::create(
     UniqueId id, WGPUDevice device, uint32_t width, uint32_t height, bool isRenderAttachment
 ) {
-    int usage = WGPUTextureUsage_TextureBinding;
+    int usage = WGPUTextureUsage_TextureBinding | WGPUTextureUsage_CopySrc;
 
     if (isRenderAttachment) {
         usage |= WGPUTextureUsage_RenderAttachment;
@@ -89,5 +177,29 @@ std::unique_ptr<Texture2D> Texture2D::create(
     };
     WGPUTextureView textureView = wgpuTextureCreateView(texture, &textureViewDescriptor);
 
-    return std::unique_ptr<Texture2D>(new Texture2D(id, texture, textureView, width, height));
+    WGPUTextureViewDescriptor arrayTextureViewDescriptor = textureViewDescriptor;
+    arrayTextureViewDescriptor.dimension = WGPUTextureViewDimension_2DArray;
+
+    WGPUTextureView arrayTextureView = wgpuTextureCreateView(texture, &arrayTextureViewDescriptor);
+
+    return std::unique_ptr<Texture2D>(new Texture2D(id, texture, textureView, arrayTextureView, width, height, 1));
+}
+
+std::unique_ptr<Texture2D> Texture2D::createRegion(UniqueId id, std::shared_ptr<Texture2D> page, glm::vec4 uvRect) {
+    auto width = static_cast<uint32_t>(std::lround(uvRect.z * static_cast<float>(page->width())));
+    auto height = static_cast<uint32_t>(std::lround(uvRect.w * static_cast<float>(page->height())));
+
+    return std::unique_ptr<Texture2D>(new Texture2D(id, std::move(page), uvRect, width, height));
+}
+
+size_t Texture2D::addDestroyListener(DestroyListener listener) {
+    auto handle = s_nextDestroyListenerHandle++;
+
+    s_destroyListeners->emplace(handle, std::move(listener));
+
+    return handle;
+}
+
+void Texture2D::removeDestroyListener(size_t handle) {
+    s_destroyListeners->erase(handle);
 }
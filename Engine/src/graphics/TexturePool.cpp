@@ -0,0 +1,265 @@
+#include "delusion/graphics/TexturePool.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+
+// Mip levels of the pool, textures are packed at multiples of the alignment so every level stays texel aligned.
+static constexpr uint32_t s_mipLevelCount = 4;
+static constexpr uint32_t s_alignment = 1 << (s_mipLevelCount - 1);
+
+// Border around every packed texture, filled with its edge texels like the atlas builder does.
+// It shrinks to a single texel in the smallest mip level.
+static constexpr uint32_t s_padding = s_alignment;
+
+static uint32_t alignUp(uint32_t value, uint32_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+static void copyTexels(
+    WGPUCommandEncoder commandEncoder, WGPUTexture sourceTexture, uint32_t sourceMipLevel, WGPUOrigin3D sourceOrigin,
+    WGPUTexture destinationTexture, uint32_t destinationMipLevel, WGPUOrigin3D destinationOrigin, uint32_t width,
+    uint32_t height
+) {
+    WGPUImageCopyTexture source = {
+        .nextInChain = nullptr,
+        .texture = sourceTexture,
+        .mipLevel = sourceMipLevel,
+        .origin = sourceOrigin,
+        .aspect = WGPUTextureAspect_All,
+    };
+    WGPUImageCopyTexture destination = {
+        .nextInChain = nullptr,
+        .texture = destinationTexture,
+        .mipLevel = destinationMipLevel,
+        .origin = destinationOrigin,
+        .aspect = WGPUTextureAspect_All,
+    };
+    WGPUExtent3D copySize = { width, height, 1 };
+
+    wgpuCommandEncoderCopyTextureToTexture(commandEncoder, &source, &destination, &copySize);
+}
+
+TexturePool::TexturePool(
+    WGPUTexture texture, WGPUTextureView textureView, WGPUTexture edgeTexture, uint32_t pageSize, uint32_t layerCount,
+    uint32_t maxTextureSize
+)
+    : m_texture(texture), m_textureView(textureView), m_edgeTexture(edgeTexture), m_pageSize(pageSize),
+      m_maxTextureSize(maxTextureSize) {
+    m_layers.reserve(layerCount);
+
+    for (uint32_t layerIndex = 0; layerIndex < layerCount; layerIndex++) {
+        m_layers.push_back(Layer { .packer = SkylinePacker(pageSize, pageSize) });
+    }
+}
+
+TexturePool::~TexturePool() {
+    Texture2D::removeDestroyListener(m_destroyListenerHandle);
+
+    wgpuTextureRelease(m_edgeTexture);
+    wgpuTextureViewRelease(m_textureView);
+    wgpuTextureRelease(m_texture);
+}
+
+std::unique_ptr<TexturePool> TexturePool::create(
+    WGPUDevice device, uint32_t pageSize, uint32_t layerCount, uint32_t maxTextureSize
+) {
+    WGPUTextureDescriptor textureDescriptor = {
+        .nextInChain = nullptr,
+        .label = "Texture pool",
+        .usage = WGPUTextureUsage_TextureBinding | WGPUTextureUsage_CopySrc | WGPUTextureUsage_CopyDst,
+        .dimension = WGPUTextureDimension_2D,
+        .size = WGPUExtent3D { pageSize, pageSize, layerCount },
+        .format = WGPUTextureFormat_RGBA8Unorm,
+        .mipLevelCount = s_mipLevelCount,
+        .sampleCount = 1,
+        .viewFormatCount = 0,
+        .viewFormats = nullptr,
+    };
+    WGPUTexture texture = wgpuDeviceCreateTexture(device, &textureDescriptor);
+
+    WGPUTextureViewDescriptor textureViewDescriptor = {
+        .nextInChain = nullptr,
+        .format = textureDescriptor.format,
+        .dimension = WGPUTextureViewDimension_2DArray,
+        .baseMipLevel = 0,
+        .mipLevelCount = s_mipLevelCount,
+        .baseArrayLayer = 0,
+        .arrayLayerCount = layerCount,
+        .aspect = WGPUTextureAspect_All,
+    };
+    WGPUTextureView textureView = wgpuTextureCreateView(texture, &textureViewDescriptor);
+
+    WGPUTextureDescriptor edgeTextureDescriptor = {
+        .nextInChain = nullptr,
+        .label = "Texture pool edges",
+        .usage = WGPUTextureUsage_CopySrc | WGPUTextureUsage_CopyDst,
+        .dimension = WGPUTextureDimension_2D,
+        .size = WGPUExtent3D { alignUp(maxTextureSize, s_alignment) + 2 * s_padding, 2, 1 },
+        .format = textureDescriptor.format,
+        .mipLevelCount = 1,
+        .sampleCount = 1,
+        .viewFormatCount = 0,
+        .viewFormats = nullptr,
+    };
+    WGPUTexture edgeTexture = wgpuDeviceCreateTexture(device, &edgeTextureDescriptor);
+
+    auto texturePool = std::unique_ptr<TexturePool>(
+        new TexturePool(texture, textureView, edgeTexture, pageSize, layerCount, maxTextureSize)
+    );
+
+    texturePool->m_destroyListenerHandle = Texture2D::addDestroyListener(
+        [pool = texturePool.get()](Texture2D &texture) { pool->release(texture); }
+    );
+
+    return texturePool;
+}
+
+TextureRegion TexturePool::region(WGPUCommandEncoder commandEncoder, Texture2D &texture) {
+    // Atlas regions are already packed, only their page goes through the pool.
+    if (texture.isRegion()) {
+        auto pageRegion = region(commandEncoder, *texture.page());
+
+        auto uvRect = texture.uvRect();
+
+        pageRegion.uvRect = glm::vec4(
+            glm::vec2(pageRegion.uvRect) + glm::vec2(uvRect) * glm::vec2(pageRegion.uvRect.z, pageRegion.uvRect.w),
+            glm::vec2(uvRect.z, uvRect.w) * glm::vec2(pageRegion.uvRect.z, pageRegion.uvRect.w)
+        );
+
+        return pageRegion;
+    }
+
+    TextureRegion standalone = {
+        .view = texture.arrayView(),
+        .layer = 0,
+        .uvRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f),
+    };
+
+    auto result = m_entries.find(&texture);
+
+    if (result != m_entries.end()) {
+        if (result->second.layer == UINT32_MAX) {
+            return standalone;
+        }
+
+        return TextureRegion { .view = m_textureView, .layer = result->second.layer, .uvRect = result->second.uvRect };
+    }
+
+    // Smaller mip levels are copied from the texture's own, so only textures with a full mip chain qualify.
+    bool hasFullMipChain =
+        texture.mipLevelCount() == static_cast<uint32_t>(std::bit_width(std::max(texture.width(), texture.height())));
+
+    bool isPoolable = texture.width() <= m_maxTextureSize && texture.height() <= m_maxTextureSize &&
+                      (wgpuTextureGetUsage(texture.texture()) & WGPUTextureUsage_RenderAttachment) == 0 &&
+                      hasFullMipChain;
+
+    if (isPoolable) {
+        for (uint32_t layerIndex = 0; layerIndex < m_layers.size(); layerIndex++) {
+            auto &layer = m_layers[layerIndex];
+
+            // Aligned sizes keep every packed position aligned too
+            auto position = layer.packer.pack(
+                alignUp(texture.width(), s_alignment) + 2 * s_padding,
+                alignUp(texture.height(), s_alignment) + 2 * s_padding
+            );
+
+            if (!position.has_value())
+                continue;
+
+            uint32_t x = position->x + s_padding;
+            uint32_t y = position->y + s_padding;
+
+            // Textures smaller than the alignment run out of mip levels first, their 1x1 level fills the rest.
+            for (uint32_t mipLevel = 0; mipLevel < s_mipLevelCount; mipLevel++) {
+                uint32_t sourceMipLevel = std::min(mipLevel, texture.mipLevelCount() - 1);
+
+                uint32_t levelX = x >> mipLevel;
+                uint32_t levelY = y >> mipLevel;
+                uint32_t width = std::max(texture.width() >> sourceMipLevel, 1u);
+                uint32_t height = std::max(texture.height() >> sourceMipLevel, 1u);
+                uint32_t padding = s_padding >> mipLevel;
+
+                copyTexels(
+                    commandEncoder, texture.texture(), sourceMipLevel, { 0, 0, 0 }, m_texture, mipLevel,
+                    { levelX, levelY, layerIndex }, width, height
+                );
+
+                // Edge columns first, then the rows (corners included) from the extruded top and bottom rows
+                for (uint32_t offset = 1; offset <= padding; offset++) {
+                    copyTexels(
+                        commandEncoder, texture.texture(), sourceMipLevel, { 0, 0, 0 }, m_texture, mipLevel,
+                        { levelX - offset, levelY, layerIndex }, 1, height
+                    );
+                    copyTexels(
+                        commandEncoder, texture.texture(), sourceMipLevel, { width - 1, 0, 0 }, m_texture, mipLevel,
+                        { levelX + width - 1 + offset, levelY, layerIndex }, 1, height
+                    );
+                }
+
+                uint32_t paddedWidth = width + 2 * padding;
+
+                copyTexels(
+                    commandEncoder, m_texture, mipLevel, { levelX - padding, levelY, layerIndex }, m_edgeTexture, 0,
+                    { 0, 0, 0 }, paddedWidth, 1
+                );
+                copyTexels(
+                    commandEncoder, m_texture, mipLevel, { levelX - padding, levelY + height - 1, layerIndex },
+                    m_edgeTexture, 0, { 0, 1, 0 }, paddedWidth, 1
+                );
+
+                for (uint32_t offset = 1; offset <= padding; offset++) {
+                    copyTexels(
+                        commandEncoder, m_edgeTexture, 0, { 0, 0, 0 }, m_texture, mipLevel,
+                        { levelX - padding, levelY - offset, layerIndex }, paddedWidth, 1
+                    );
+                    copyTexels(
+                        commandEncoder, m_edgeTexture, 0, { 0, 1, 0 }, m_texture, mipLevel,
+                        { levelX - padding, levelY + height - 1 + offset, layerIndex }, paddedWidth, 1
+                    );
+                }
+            }
+
+            // The border holds the edge texels, so the full rect can be sampled with filtering
+            auto pageSize = static_cast<float>(m_pageSize);
+
+            glm::vec4 uvRect = glm::vec4(
+                static_cast<float>(x) / pageSize, static_cast<float>(y) / pageSize,
+                static_cast<float>(texture.width()) / pageSize, static_cast<float>(texture.height()) / pageSize
+            );
+
+            layer.textureCount += 1;
+
+            m_entries.emplace(&texture, Entry { .layer = layerIndex, .uvRect = uvRect });
+
+            return TextureRegion { .view = m_textureView, .layer = layerIndex, .uvRect = uvRect };
+        }
+    }
+
+    // Remembered as standalone, so textures which didn't fit aren't retried every frame.
+    m_entries.emplace(&texture, Entry { .layer = UINT32_MAX, .uvRect = standalone.uvRect });
+
+    return standalone;
+}
+
+void TexturePool::release(Texture2D &texture) {
+    auto result = m_entries.find(&texture);
+
+    if (result == m_entries.end())
+        return;
+
+    uint32_t layerIndex = result->second.layer;
+
+    m_entries.erase(result);
+
+    if (layerIndex == UINT32_MAX)
+        return;
+
+    auto &layer = m_layers[layerIndex];
+
+    layer.textureCount -= 1;
+
+    if (layer.textureCount == 0) {
+        layer.packer.reset();
+    }
+}
@@ -0,0 +1,110 @@
+#include "delusion/graphics/TextureReadback.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include <wgpu.h>
+
+static constexpr uint32_t s_bytesPerPixel = 4;
+
+TextureReadback::~TextureReadback() {
+    // The map callback points to this readback, so it has to complete first.
+    wait();
+
+    wgpuBufferRelease(m_buffer);
+}
+
+std::unique_ptr<TextureReadback> TextureReadback::create(WGPUDevice device, uint32_t width, uint32_t height) {
+    uint32_t paddedBytesPerRow = (width * s_bytesPerPixel + 255) / 256 * 256;
+
+    WGPUBufferDescriptor bufferDescriptor = {
+        .nextInChain = nullptr,
+        .label = "Texture readback buffer",
+        .usage = WGPUBufferUsage_MapRead | WGPUBufferUsage_CopyDst,
+        .size = static_cast<uint64_t>(paddedBytesPerRow) * height,
+        .mappedAtCreation = false,
+    };
+    WGPUBuffer buffer = wgpuDeviceCreateBuffer(device, &bufferDescriptor);
+
+    return std::unique_ptr<TextureReadback>(new TextureReadback(device, buffer, width, height, paddedBytesPerRow));
+}
+
+void TextureReadback::copy(WGPUCommandEncoder commandEncoder, Texture2D &texture) {
+    if (texture.width() != m_width || texture.height() != m_height) {
+        throw std::invalid_argument("Texture size doesn't match the readback size");
+    }
+
+    if (m_isReading) {
+        throw std::runtime_error("Can't copy into a readback which is being read");
+    }
+
+    WGPUImageCopyTexture source = {
+        .nextInChain = nullptr,
+        .texture = texture.texture(),
+        .mipLevel = 0,
+        .origin = { 0, 0, 0 },
+        .aspect = WGPUTextureAspect_All,
+    };
+    WGPUImageCopyBuffer destination = {
+        .nextInChain = nullptr,
+        .layout =
+            WGPUTextureDataLayout {
+                .nextInChain = nullptr,
+                .offset = 0,
+                .bytesPerRow = m_paddedBytesPerRow,
+                .rowsPerImage = m_height,
+            },
+        .buffer = m_buffer,
+    };
+    WGPUExtent3D copySize = { m_width, m_height, 1 };
+
+    wgpuCommandEncoderCopyTextureToBuffer(commandEncoder, &source, &destination, &copySize);
+}
+
+void TextureReadback::read(Callback callback) {
+    if (m_isReading) {
+        throw std::runtime_error("Texture readback is already being read");
+    }
+
+    m_isReading = true;
+    m_callback = std::move(callback);
+
+    auto onMapped = [](WGPUBufferMapAsyncStatus status, void *userData) {
+        auto &readback = *static_cast<TextureReadback *>(userData);
+
+        if (status == WGPUBufferMapAsyncStatus_Success) {
+            auto rowSize = readback.m_width * s_bytesPerPixel;
+            auto bufferSize = static_cast<size_t>(readback.m_paddedBytesPerRow) * readback.m_height;
+
+            const auto *mappedData =
+                static_cast<const uint8_t *>(wgpuBufferGetConstMappedRange(readback.m_buffer, 0, bufferSize));
+
+            std::vector<uint8_t> pixels(static_cast<size_t>(rowSize) * readback.m_height);
+
+            for (uint32_t row = 0; row < readback.m_height; row++) {
+                std::copy_n(
+                    mappedData + static_cast<size_t>(row) * readback.m_paddedBytesPerRow, rowSize,
+                    pixels.begin() + static_cast<ptrdiff_t>(row) * rowSize
+                );
+            }
+
+            wgpuBufferUnmap(readback.m_buffer);
+
+            Image image(readback.m_width, readback.m_height, std::move(pixels));
+
+            readback.m_callback(image);
+        }
+
+        readback.m_isReading = false;
+    };
+    wgpuBufferMapAsync(
+        m_buffer, WGPUMapMode_Read, 0, static_cast<size_t>(m_paddedBytesPerRow) * m_height, onMapped, this
+    );
+}
+
+void TextureReadback::wait() {
+    while (m_isReading) {
+        wgpuDevicePoll(m_device, true, nullptr);
+    }
+}
@@ -0,0 +1,71 @@
+#include "delusion/graphics/UploadRing.hpp"
+
+#include <algorithm>
+
+static uint64_t alignUp(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+UploadRing::UploadRing(WGPUDevice device, WGPUQueue queue, WGPUBufferUsageFlags usage, uint64_t chunkSize)
+    : m_device(device), m_queue(queue), m_usage(usage | WGPUBufferUsage_CopyDst), m_chunkSize(chunkSize) {}
+
+UploadRing::~UploadRing() {
+    for (auto &chunk : m_chunks) {
+        wgpuBufferRelease(chunk.buffer);
+    }
+}
+
+std::unique_ptr<UploadRing> UploadRing::create(
+    WGPUDevice device, WGPUQueue queue, WGPUBufferUsageFlags usage, uint64_t chunkSize
+) {
+    return std::unique_ptr<UploadRing>(new UploadRing(device, queue, usage, chunkSize));
+}
+
+void UploadRing::beginFrame() {
+    for (auto &chunk : m_chunks) {
+        chunk.used = 0;
+    }
+}
+
+UploadAllocation UploadRing::allocate(uint64_t size, uint64_t alignment) {
+    for (auto &chunk : m_chunks) {
+        auto offset = alignUp(chunk.used, alignment);
+
+        if (offset + size <= chunk.size) {
+            chunk.used = offset + size;
+
+            return { chunk.buffer, offset, std::span<uint8_t>(chunk.shadow).subspan(offset, size) };
+        }
+    }
+
+    // Allocations bigger than the chunk size get a dedicated chunk, it's reused like any other one afterwards.
+    auto chunkSize = alignUp(std::max(size, m_chunkSize), 4);
+
+    WGPUBufferDescriptor bufferDescriptor = {
+        .nextInChain = nullptr,
+        .label = "Upload ring chunk",
+        .usage = m_usage,
+        .size = chunkSize,
+        .mappedAtCreation = false,
+    };
+    WGPUBuffer buffer = wgpuDeviceCreateBuffer(m_device, &bufferDescriptor);
+
+    m_createdBufferCount += 1;
+
+    auto &chunk = m_chunks.emplace_back(Chunk {
+        .buffer = buffer,
+        .size = chunkSize,
+        .used = size,
+        .shadow = std::vector<uint8_t>(chunkSize),
+    });
+
+    return { chunk.buffer, 0, std::span<uint8_t>(chunk.shadow).subspan(0, size) };
+}
+
+void UploadRing::flush() {
+    for (auto &chunk : m_chunks) {
+        if (chunk.used > 0) {
+            wgpuQueueWriteBuffer(m_queue, chunk.buffer, 0, chunk.shadow.data(), alignUp(chunk.used, 4));
+        }
+    }
+}
@@ -0,0 +1,87 @@
+#include "delusion/threading/ThreadPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <latch>
+
+ThreadPool::ThreadPool(size_t threadCount) {
+    m_threads.reserve(threadCount);
+
+    for (size_t threadIndex = 0; threadIndex < threadCount; threadIndex++) {
+        m_threads.emplace_back([this]() { work(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(m_mutex);
+
+        m_isStopping = true;
+    }
+
+    m_condition.notify_all();
+
+    for (auto &thread : m_threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard lock(m_mutex);
+
+        m_tasks.push_back(std::move(task));
+    }
+
+    m_condition.notify_one();
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)> &task) {
+    if (count == 0)
+        return;
+
+    std::atomic<size_t> nextIndex = 0;
+
+    auto runTasks = [&]() {
+        for (size_t index = nextIndex++; index < count; index = nextIndex++) {
+            task(index);
+        }
+    };
+
+    // The calling thread takes part as well, so one helper less is needed
+    auto helperCount = static_cast<ptrdiff_t>(std::min(count - 1, m_threads.size()));
+
+    std::latch helpersDone(helperCount);
+
+    for (ptrdiff_t helperIndex = 0; helperIndex < helperCount; helperIndex++) {
+        submit([&]() {
+            runTasks();
+
+            helpersDone.count_down();
+        });
+    }
+
+    runTasks();
+
+    helpersDone.wait();
+}
+
+void ThreadPool::work() {
+    while (true) {
+        std::function<void()> task;
+
+        {
+            std::unique_lock lock(m_mutex);
+
+            m_condition.wait(lock, [this]() { return m_isStopping || !m_tasks.empty(); });
+
+            if (m_tasks.empty())
+                return;
+
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+
+        task();
+    }
+}
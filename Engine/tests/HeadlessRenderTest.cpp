@@ -0,0 +1,155 @@
+#include <array>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "delusion/graphics/GraphicsBackend.hpp"
+#include "delusion/graphics/OrthographicCamera.hpp"
+#include "delusion/graphics/Renderer.hpp"
+#include "delusion/graphics/Texture2D.hpp"
+#include "delusion/graphics/TextureReadback.hpp"
+#include "delusion/Scene.hpp"
+
+// The camera sees from -1 to 1 on both axes, a unit sprite at the origin covers the middle half of the target.
+static constexpr uint32_t s_targetSize = 64;
+
+struct Pixel {
+        uint8_t r;
+        uint8_t g;
+        uint8_t b;
+};
+
+static Pixel pixelAt(Image &image, uint32_t x, uint32_t y) {
+    auto pixels = image.pixels();
+    auto index = (static_cast<size_t>(y) * image.width() + x) * 4;
+
+    return { pixels[index], pixels[index + 1], pixels[index + 2] };
+}
+
+static bool isRed(Pixel pixel) {
+    return pixel.r > 200 && pixel.g < 50 && pixel.b < 50;
+}
+
+// The renderer clears to opaque black.
+static bool isBlack(Pixel pixel) {
+    return pixel.r < 50 && pixel.g < 50 && pixel.b < 50;
+}
+
+static std::shared_ptr<Texture2D> createRedTexture(GraphicsBackend &backend) {
+    std::vector<uint8_t> pixels;
+
+    for (uint32_t index = 0; index < 4 * 4; index++) {
+        pixels.insert(pixels.end(), { 255, 0, 0, 255 });
+    }
+
+    Image image(4, 4, std::move(pixels));
+
+    return Texture2D::create(UniqueId(), backend.device(), backend.queue(), image);
+}
+
+static void addSprite(Scene &scene, const std::shared_ptr<Texture2D> &texture, glm::vec2 position, bool isStatic) {
+    auto entity = scene.create();
+
+    entity.addComponent<TransformComponent>(position, glm::vec2(1.0f, 1.0f), 0.0f);
+    entity.addComponent<SpriteComponent>(SpriteComponent { .texture = texture, .isStatic = isStatic });
+}
+
+// Renders the scene into an offscreen texture and reads it back, blocking until it's done.
+static std::optional<Image> render(GraphicsBackend &backend, Renderer &renderer, Scene &scene) {
+    auto renderTarget = Texture2D::create(UniqueId(), backend.device(), s_targetSize, s_targetSize, true);
+    auto readback = TextureReadback::create(backend.device(), s_targetSize, s_targetSize);
+
+    OrthographicCamera camera(glm::vec3(0.0f, 0.0f, -1.0f));
+
+    WGPUCommandEncoderDescriptor encoderDescriptor = {
+        .nextInChain = nullptr,
+        .label = "Command encoder",
+    };
+    WGPUCommandEncoder commandEncoder = wgpuDeviceCreateCommandEncoder(backend.device(), &encoderDescriptor);
+
+    renderer.renderScene(commandEncoder, renderTarget->view(), camera, scene);
+    readback->copy(commandEncoder, *renderTarget);
+
+    WGPUCommandBufferDescriptor commandBufferDescriptor = {
+        .nextInChain = nullptr,
+        .label = "Command buffer",
+    };
+    WGPUCommandBuffer commandBuffer = wgpuCommandEncoderFinish(commandEncoder, &commandBufferDescriptor);
+
+    wgpuQueueSubmit(backend.queue(), 1, &commandBuffer);
+
+    wgpuCommandBufferRelease(commandBuffer);
+    wgpuCommandEncoderRelease(commandEncoder);
+
+    std::optional<Image> result;
+
+    readback->read([&](Image &image) { result = image; });
+    readback->wait();
+
+    return result;
+}
+
+static bool spriteIsDrawnWhereItIs(GraphicsBackend &backend, Renderer &renderer) {
+    Scene scene;
+
+    addSprite(scene, createRedTexture(backend), glm::vec2(0.0f, 0.0f), false);
+
+    auto image = render(backend, renderer, scene);
+
+    if (!image.has_value())
+        return false;
+
+    return isRed(pixelAt(*image, s_targetSize / 2, s_targetSize / 2)) && isBlack(pixelAt(*image, 2, 2)) &&
+           renderer.statistics().sprites == 1;
+}
+
+static bool staticSpritesOutOfViewAreCulled(GraphicsBackend &backend, Renderer &renderer) {
+    Scene scene;
+
+    auto texture = createRedTexture(backend);
+
+    addSprite(scene, texture, glm::vec2(0.0f, 0.0f), true);
+    addSprite(scene, texture, glm::vec2(100.0f, 100.0f), true);
+
+    auto image = render(backend, renderer, scene);
+
+    if (!image.has_value())
+        return false;
+
+    const auto &statistics = renderer.statistics();
+
+    return isRed(pixelAt(*image, s_targetSize / 2, s_targetSize / 2)) && isBlack(pixelAt(*image, 2, 2)) &&
+           statistics.staticSprites == 1 && statistics.culledSprites == 1;
+}
+
+int main() {
+    struct Test {
+            const char *name;
+            bool (*run)(GraphicsBackend &backend, Renderer &renderer);
+    };
+
+    std::array<Test, 2> tests = {
+        Test { "Sprite is drawn where it is", &spriteIsDrawnWhereItIs },
+        Test { "Static sprites out of view are culled", &staticSpritesOutOfViewAreCulled },
+    };
+
+    GraphicsBackend backend;
+    backend.setupHeadless();
+
+    // Declared after the backend, so it's destroyed before the device
+    Renderer renderer = Renderer::create(backend.device(), backend.queue(), {}, DELUSION_SHADER_PATH);
+
+    int failureCount = 0;
+
+    for (const auto &test : tests) {
+        if (!test.run(backend, renderer)) {
+            std::cerr << "Failed: " << test.name << std::endl;
+
+            failureCount += 1;
+        }
+    }
+
+    return failureCount == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
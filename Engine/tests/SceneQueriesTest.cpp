@@ -0,0 +1,199 @@
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+
+#include "delusion/Scene.hpp"
+
+// Static 2x2 box centered at the given position.
+static Entity createWall(Scene &scene, glm::vec2 position = glm::vec2(0.0f, 0.0f)) {
+    auto wall = scene.create();
+
+    wall.addComponent<TransformComponent>(position, glm::vec2(2.0f, 2.0f), 0.0f);
+    wall.addComponent<RigidbodyComponent>();
+    wall.addComponent<BoxColliderComponent>();
+
+    return wall;
+}
+
+static bool queryOverlapsCountsResultsPerQuery() {
+    Scene scene;
+
+    auto left = createWall(scene);
+    auto right = createWall(scene, glm::vec2(10.0f, 0.0f));
+
+    scene.start();
+
+    std::array<BoundingBox, 3> queries = {
+        BoundingBox { glm::vec2(-0.5f, -0.5f), glm::vec2(0.5f, 0.5f) },
+        BoundingBox { glm::vec2(4.0f, -0.5f), glm::vec2(5.0f, 0.5f) },
+        BoundingBox { glm::vec2(9.5f, -0.5f), glm::vec2(10.5f, 0.5f) },
+    };
+    std::array<UniqueId, 4> results {};
+    std::array<uint32_t, 3> resultCounts {};
+
+    auto resultCount = scene.queryOverlaps(queries, results, resultCounts);
+
+    return resultCount == 2 && resultCounts[0] == 1 && resultCounts[1] == 0 && resultCounts[2] == 1 &&
+           results[0] == left.id() && results[1] == right.id();
+}
+
+static bool queryOverlapsDropsResultsThatDontFit() {
+    Scene scene;
+
+    auto wall = createWall(scene);
+
+    scene.start();
+
+    std::array<BoundingBox, 2> queries = {
+        BoundingBox { glm::vec2(-0.5f, -0.5f), glm::vec2(0.5f, 0.5f) },
+        BoundingBox { glm::vec2(0.5f, -0.5f), glm::vec2(1.5f, 0.5f) },
+    };
+    std::array<UniqueId, 1> results {};
+    std::array<uint32_t, 2> resultCounts = { 7, 7 };
+
+    auto resultCount = scene.queryOverlaps(queries, results, resultCounts);
+
+    return resultCount == 1 && resultCounts[0] == 1 && resultCounts[1] == 0 && results[0] == wall.id();
+}
+
+static bool queryOverlapsRejectsTooFewResultCounts() {
+    Scene scene;
+
+    createWall(scene);
+
+    scene.start();
+
+    std::array<BoundingBox, 2> queries = {
+        BoundingBox { glm::vec2(-0.5f, -0.5f), glm::vec2(0.5f, 0.5f) },
+        BoundingBox { glm::vec2(0.5f, -0.5f), glm::vec2(1.5f, 0.5f) },
+    };
+    std::array<UniqueId, 2> results {};
+    std::array<uint32_t, 1> resultCounts {};
+
+    try {
+        scene.queryOverlaps(queries, results, resultCounts);
+    } catch (const std::invalid_argument &) {
+        return true;
+    }
+
+    return false;
+}
+
+static bool raycastHitsTheClosestCollider() {
+    Scene scene;
+
+    auto left = createWall(scene);
+    createWall(scene, glm::vec2(10.0f, 0.0f));
+
+    scene.start();
+
+    std::array<RaycastQuery, 2> queries = {
+        RaycastQuery { .from = glm::vec2(-10.0f, 0.0f), .to = glm::vec2(20.0f, 0.0f) },
+        RaycastQuery { .from = glm::vec2(-10.0f, 5.0f), .to = glm::vec2(20.0f, 5.0f) },
+    };
+    std::array<QueryHit, 2> hits {};
+
+    scene.raycast(queries, hits);
+
+    const auto &hit = hits[0];
+
+    return hit.isHit != 0 && hit.id == left.id() && std::abs(hit.point.x + 1.0f) < 1e-3f &&
+           std::abs(hit.normal.x + 1.0f) < 1e-3f && std::abs(hit.fraction - 0.3f) < 1e-3f && hits[1].isHit == 0;
+}
+
+static bool raycastRejectsTooFewHits() {
+    Scene scene;
+
+    createWall(scene);
+
+    scene.start();
+
+    std::array<RaycastQuery, 2> queries = {
+        RaycastQuery { .from = glm::vec2(-10.0f, 0.0f), .to = glm::vec2(10.0f, 0.0f) },
+        RaycastQuery { .from = glm::vec2(0.0f, -10.0f), .to = glm::vec2(0.0f, 10.0f) },
+    };
+    std::array<QueryHit, 1> hits {};
+
+    try {
+        scene.raycast(queries, hits);
+    } catch (const std::invalid_argument &) {
+        return true;
+    }
+
+    return false;
+}
+
+static bool boxCastStartingOutsideHitsOnTheWay() {
+    Scene scene;
+
+    auto wall = createWall(scene);
+
+    scene.start();
+
+    std::array<BoxCastQuery, 1> queries = {
+        BoxCastQuery {
+            .center = glm::vec2(-4.0f, 0.0f),
+            .size = glm::vec2(0.5f, 0.5f),
+            .translation = glm::vec2(8.0f, 0.0f),
+            .rotation = 0.0f,
+        },
+    };
+    std::array<QueryHit, 1> hits {};
+
+    scene.boxCast(queries, hits);
+
+    return hits[0].isHit != 0 && hits[0].id == wall.id() && hits[0].fraction > 0.0f && hits[0].fraction < 0.5f;
+}
+
+static bool boxCastStartingInsideHitsAtTheStart() {
+    Scene scene;
+
+    auto wall = createWall(scene);
+
+    scene.start();
+
+    std::array<BoxCastQuery, 1> queries = {
+        BoxCastQuery {
+            .center = glm::vec2(0.25f, 0.0f),
+            .size = glm::vec2(0.5f, 0.5f),
+            .translation = glm::vec2(8.0f, 0.0f),
+            .rotation = 0.0f,
+        },
+    };
+    std::array<QueryHit, 1> hits {};
+
+    scene.boxCast(queries, hits);
+
+    return hits[0].isHit != 0 && hits[0].id == wall.id() && hits[0].fraction == 0.0f;
+}
+
+int main() {
+    struct Test {
+            const char *name;
+            bool (*run)();
+    };
+
+    std::array<Test, 7> tests = {
+        Test { "Overlap query counts results per query", &queryOverlapsCountsResultsPerQuery },
+        Test { "Overlap query drops results that don't fit", &queryOverlapsDropsResultsThatDontFit },
+        Test { "Overlap query rejects too few result counts", &queryOverlapsRejectsTooFewResultCounts },
+        Test { "Raycast hits the closest collider", &raycastHitsTheClosestCollider },
+        Test { "Raycast rejects too few hits", &raycastRejectsTooFewHits },
+        Test { "Box cast starting outside hits on the way", &boxCastStartingOutsideHitsOnTheWay },
+        Test { "Box cast starting inside hits at the start", &boxCastStartingInsideHitsAtTheStart },
+    };
+
+    int failureCount = 0;
+
+    for (const auto &test : tests) {
+        if (!test.run()) {
+            std::cerr << "Failed: " << test.name << std::endl;
+
+            failureCount += 1;
+        }
+    }
+
+    return failureCount == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
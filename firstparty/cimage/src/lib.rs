@@ -55,3 +55,21 @@ pub unsafe extern "C" fn cimage_image_free(image: *mut cimage_image) {
         (image.width * image.height) as usize,
     ));
 }
+
+#[no_mangle]
+pub unsafe extern "C" fn cimage_image_encode_to_file(path: *const c_char, image: *const cimage_image) -> bool {
+    let path = unsafe { CStr::from_ptr(path) };
+    let path = path.to_str().unwrap();
+
+    let image = unsafe { &*image };
+
+    let pixels = unsafe {
+        std::slice::from_raw_parts(image.pixels as *const u8, (image.width * image.height * 4) as usize)
+    };
+
+    let Some(buffer) = image::RgbaImage::from_raw(image.width, image.height, pixels.to_vec()) else {
+        return false;
+    };
+
+    image::imageops::flip_vertical(&buffer).save(path).is_ok()
+}